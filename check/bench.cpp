@@ -0,0 +1,724 @@
+/** @file bench.cpp
+ *
+ *  Driver running the timings in one program.  It repeats them after some
+ *  warm-up runs, measures processor and wall clock time, peak memory and
+ *  the number of expression objects created, writes the results as text,
+ *  JSON or CSV, and compares them with the results of an earlier run.
+ *  Some of the timings can also be run for a range of problem sizes. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include "ginac.h"
+#include "timer.h"
+using namespace GiNaC;
+
+#ifdef HAVE_GETTIMEOFDAY
+#include <sys/time.h>
+#endif
+#ifdef HAVE_RUSAGE
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+using namespace std;
+
+extern void randomify_symbol_serials();
+
+extern unsigned time_antipode();
+extern unsigned time_color_trace();
+extern unsigned time_dennyfliegner();
+extern unsigned time_dirac_trace();
+extern unsigned time_fateman_expand();
+extern unsigned time_gammaseries();
+extern unsigned time_hashmap();
+extern unsigned time_integral();
+extern unsigned time_lw_A();
+extern unsigned time_lw_B();
+extern unsigned time_lw_C();
+extern unsigned time_lw_D();
+extern unsigned time_lw_E();
+extern unsigned time_lw_F();
+extern unsigned time_lw_G();
+extern unsigned time_lw_H();
+extern unsigned time_lw_IJKL();
+extern unsigned time_lw_M1();
+extern unsigned time_lw_M2();
+extern unsigned time_lw_N();
+extern unsigned time_lw_O();
+extern unsigned time_lw_P();
+extern unsigned time_lw_Pprime();
+extern unsigned time_lw_Q();
+extern unsigned time_lw_Qprime();
+extern unsigned time_mvar_gcd();
+extern unsigned time_parser(unsigned n_max, unsigned mbytes);
+extern unsigned time_pattern_set();
+extern unsigned time_toeplitz();
+extern unsigned time_uvar_gcd();
+extern unsigned time_vandermonde();
+
+extern unsigned color_trace_crossed(unsigned length);
+extern unsigned dirac_trace_slashes(unsigned length);
+extern unsigned fateman_expand(unsigned n);
+extern unsigned integral_evalf(unsigned count);
+extern unsigned mvar_gcd(unsigned degree);
+extern unsigned parse_big_sum(unsigned mbytes);
+extern unsigned pattern_set_find(unsigned count);
+extern unsigned toeplitz_det(unsigned size);
+extern unsigned vandermonde_det(unsigned size);
+
+/// time_parser with the sizes its own main() uses
+static unsigned time_parser_default()
+{
+	return time_parser(32768, 4);
+}
+
+struct benchmark {
+	const char* name;
+	unsigned (*run)();
+};
+
+static const benchmark benchmarks[] = {
+	{ "antipode", time_antipode },
+	{ "color_trace", time_color_trace },
+	{ "dennyfliegner", time_dennyfliegner },
+	{ "dirac_trace", time_dirac_trace },
+	{ "fateman_expand", time_fateman_expand },
+	{ "gammaseries", time_gammaseries },
+	{ "hashmap", time_hashmap },
+	{ "integral", time_integral },
+	{ "lw_A", time_lw_A },
+	{ "lw_B", time_lw_B },
+	{ "lw_C", time_lw_C },
+	{ "lw_D", time_lw_D },
+	{ "lw_E", time_lw_E },
+	{ "lw_F", time_lw_F },
+	{ "lw_G", time_lw_G },
+	{ "lw_H", time_lw_H },
+	{ "lw_IJKL", time_lw_IJKL },
+	{ "lw_M1", time_lw_M1 },
+	{ "lw_M2", time_lw_M2 },
+	{ "lw_N", time_lw_N },
+	{ "lw_O", time_lw_O },
+	{ "lw_P", time_lw_P },
+	{ "lw_Pprime", time_lw_Pprime },
+	{ "lw_Q", time_lw_Q },
+	{ "lw_Qprime", time_lw_Qprime },
+	{ "mvar_gcd", time_mvar_gcd },
+	{ "parser", time_parser_default },
+	{ "pattern_set", time_pattern_set },
+	{ "toeplitz", time_toeplitz },
+	{ "uvar_gcd", time_uvar_gcd },
+	{ "vandermonde", time_vandermonde }
+};
+
+static const unsigned num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+/// A computation from one of the timings, run for a list of sizes
+struct sweep {
+	const char* name;
+	unsigned (*run)(unsigned size);
+	const char* sizes;
+};
+
+// The largest sizes take hours and many GB of memory.
+static const sweep sweeps[] = {
+	{ "color_trace", color_trace_crossed, "8,10,12,14" },
+	{ "dirac_trace", dirac_trace_slashes, "8,10,12,14,16" },
+	{ "fateman_expand", fateman_expand, "20,25,30,35,40" },
+	{ "integral", integral_evalf, "10,20,40,80,160" },
+	{ "mvar_gcd", mvar_gcd, "2,4,6,8,10,12,16,20" },
+	{ "parser", parse_big_sum, "1,4,16,64,256,1024" },
+	{ "pattern_set", pattern_set_find, "10,20,40,80,160,320" },
+	{ "toeplitz", toeplitz_det, "6,8,10,12,14,16" },
+	{ "vandermonde", vandermonde_det, "6,8,10,12,14,16" }
+};
+
+static const unsigned num_sweeps = sizeof(sweeps) / sizeof(sweeps[0]);
+
+/// One thing to run and time: a timing, or a sweep at one size
+struct job {
+	job() : run(0), run_sized(0), size(0) {}
+
+	unsigned operator()() const { return run ? run() : run_sized(size); }
+
+	string name;
+	unsigned (*run)();
+	unsigned (*run_sized)(unsigned);
+	unsigned size;
+};
+
+/// Results of the timed runs of one benchmark
+struct result {
+	result() : size(0), objects(0), peak_rss_kb(0), failures(0), crashed(false) {}
+
+	string name;
+	unsigned size;          ///< 0 if not part of a sweep
+	vector<double> cpu;
+	vector<double> wall;
+	unsigned long objects;  ///< expression objects created by the cheapest run
+	long peak_rss_kb;       ///< 0 if unknown
+	unsigned failures;      ///< sum of the return values of the runs
+	bool crashed;
+};
+
+/// A baseline result, as read back from a CSV file
+struct baseline_entry {
+	double cpu_median;
+	unsigned long objects;
+};
+
+/// Swallows the output of the timings
+class null_buffer : public streambuf {
+protected:
+	int overflow(int c) { return traits_type::not_eof(c); }
+};
+
+static double median(vector<double> v)
+{
+	if (v.empty())
+		return 0;
+	sort(v.begin(), v.end());
+	const size_t n = v.size();
+	return n % 2 ? v[n/2] : (v[n/2 - 1] + v[n/2]) / 2;
+}
+
+static double minimum(const vector<double>& v)
+{
+	return v.empty() ? 0 : *min_element(v.begin(), v.end());
+}
+
+/// Wall clock time in seconds since some fixed point
+static double wall_clock()
+{
+#ifdef HAVE_GETTIMEOFDAY
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static long peak_rss_kb()
+{
+#ifdef HAVE_RUSAGE
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+#else
+	return 0;
+#endif
+}
+
+/// Run a benchmark in this process.
+static void run_benchmark(const job& b, unsigned warmup, unsigned repeat,
+                          bool verbose, result& r)
+{
+	null_buffer null;
+	streambuf* const cout_buf = cout.rdbuf();
+	if (!verbose)
+		cout.rdbuf(&null);
+
+	try {
+		for (unsigned i = 0; i < warmup; ++i)
+			r.failures += b();
+
+		timer cpu;
+		for (unsigned i = 0; i < repeat; ++i) {
+			const unsigned long objects = profiler::objects_created;
+			const double start = wall_clock();
+			cpu.start();
+			r.failures += b();
+			cpu.stop();
+			r.wall.push_back(wall_clock() - start);
+			r.cpu.push_back(cpu.read());
+			const unsigned long created = profiler::objects_created - objects;
+			if (i == 0 || created < r.objects)
+				r.objects = created;
+		}
+	} catch (const exception& e) {
+		clog << b.name << ": " << e.what() << endl;
+		r.crashed = true;
+	}
+
+	cout.rdbuf(cout_buf);
+	r.peak_rss_kb = peak_rss_kb();
+}
+
+#ifdef HAVE_RUSAGE
+/// Run a benchmark in a child process, so that it starts from a clean heap,
+/// its peak memory is its own, and a crash does not end the whole run.
+static void run_benchmark_isolated(const job& b, unsigned warmup, unsigned repeat,
+                                   bool verbose, result& r)
+{
+	int fds[2];
+	if (pipe(fds) != 0) {
+		run_benchmark(b, warmup, repeat, verbose, r);
+		return;
+	}
+	cout << flush;
+	clog << flush;
+	const pid_t pid = fork();
+	if (pid < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		run_benchmark(b, warmup, repeat, verbose, r);
+		return;
+	}
+
+	if (pid == 0) {
+		close(fds[0]);
+		run_benchmark(b, warmup, repeat, verbose, r);
+		cout << flush;
+		ostringstream os;
+		os << setprecision(17) << r.failures << ' ' << r.crashed << ' '
+		   << r.objects << ' ' << r.peak_rss_kb << ' ' << r.cpu.size();
+		for (size_t i = 0; i < r.cpu.size(); ++i)
+			os << ' ' << r.cpu[i] << ' ' << r.wall[i];
+		const string msg = os.str();
+		const char* p = msg.c_str();
+		size_t left = msg.size();
+		while (left > 0) {
+			const ssize_t n = write(fds[1], p, left);
+			if (n <= 0)
+				break;
+			p += n;
+			left -= n;
+		}
+		close(fds[1]);
+		_exit(0);
+	}
+
+	close(fds[1]);
+	string msg;
+	char buf[256];
+	ssize_t n;
+	while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+		msg.append(buf, n);
+	close(fds[0]);
+	int status = 0;
+	waitpid(pid, &status, 0);
+
+	istringstream is(msg);
+	size_t runs = 0;
+	if (!(is >> r.failures >> r.crashed >> r.objects >> r.peak_rss_kb >> runs)) {
+		clog << b.name << ": terminated abnormally" << endl;
+		r.crashed = true;
+		return;
+	}
+	for (size_t i = 0; i < runs; ++i) {
+		double cpu, wall;
+		if (!(is >> cpu >> wall))
+			break;
+		r.cpu.push_back(cpu);
+		r.wall.push_back(wall);
+	}
+}
+#endif // def HAVE_RUSAGE
+
+static string status_of(const result& r)
+{
+	if (r.crashed)
+		return "crashed";
+	return r.failures ? "failed" : "ok";
+}
+
+static void read_baseline(const string& filename, map<string, baseline_entry>& baseline)
+{
+	ifstream is(filename.c_str());
+	if (!is)
+		throw runtime_error("cannot open baseline file " + filename);
+
+	// Find the columns by their names, so that files written by other
+	// versions of this program are read as well
+	string line;
+	getline(is, line);
+	vector<string> header;
+	{
+		istringstream hs(line);
+		string col;
+		while (getline(hs, col, ','))
+			header.push_back(col);
+	}
+	const vector<string>::const_iterator name_col = find(header.begin(), header.end(), "name");
+	const vector<string>::const_iterator cpu_col = find(header.begin(), header.end(), "cpu_median");
+	const vector<string>::const_iterator obj_col = find(header.begin(), header.end(), "objects");
+	if (name_col == header.end() || cpu_col == header.end())
+		throw runtime_error(filename + " is not a CSV file written by bench");
+
+	while (getline(is, line)) {
+		vector<string> cells;
+		istringstream ls(line);
+		string cell;
+		while (getline(ls, cell, ','))
+			cells.push_back(cell);
+		// (getline() drops an empty last cell)
+		if (cells.size() <= size_t(cpu_col - header.begin()) ||
+		    cells.size() <= size_t(name_col - header.begin()))
+			continue;
+		baseline_entry entry;
+		entry.cpu_median = atof(cells[cpu_col - header.begin()].c_str());
+		const size_t obj_index = obj_col - header.begin();
+		entry.objects = obj_index < cells.size() ? strtoul(cells[obj_index].c_str(), 0, 10) : 0;
+		baseline[cells[name_col - header.begin()]] = entry;
+	}
+}
+
+/// Comparison of a result with its baseline
+struct comparison {
+	comparison() : known(false), baseline_cpu(0), cpu_change(0), slower(false), more_objects(false) {}
+
+	bool known;
+	double baseline_cpu;
+	double cpu_change;   ///< in percent
+	bool slower;
+	bool more_objects;
+};
+
+static comparison compare_to(const result& r, const map<string, baseline_entry>& baseline,
+                             double tolerance)
+{
+	comparison c;
+	const map<string, baseline_entry>::const_iterator it = baseline.find(r.name);
+	if (it == baseline.end() || r.cpu.empty())
+		return c;
+	c.known = true;
+	c.baseline_cpu = it->second.cpu_median;
+	const double cpu = median(r.cpu);
+	if (c.baseline_cpu > 0)
+		c.cpu_change = 100 * (cpu - c.baseline_cpu) / c.baseline_cpu;
+	// Differences below the resolution of the timer are noise
+	c.slower = c.cpu_change > tolerance && cpu - c.baseline_cpu > 0.01;
+	c.more_objects = it->second.objects > 0 &&
+	                 r.objects > it->second.objects * (1 + tolerance / 100);
+	return c;
+}
+
+static void print_text(ostream& os, const vector<result>& results,
+                       const map<string, baseline_entry>& baseline, double tolerance)
+{
+	os << left << setw(20) << "benchmark" << right
+	   << setw(6) << "runs" << setw(10) << "cpu min" << setw(10) << "cpu med"
+	   << setw(10) << "wall med" << setw(12) << "objects" << setw(11) << "peak kB";
+	if (!baseline.empty())
+		os << setw(10) << "base" << setw(9) << "change";
+	os << "  status" << endl;
+
+	os << fixed << setprecision(3);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result& r = results[i];
+		os << left << setw(20) << r.name << right
+		   << setw(6) << r.cpu.size() << setw(10) << minimum(r.cpu)
+		   << setw(10) << median(r.cpu) << setw(10) << median(r.wall)
+		   << setw(12) << r.objects << setw(11);
+		if (r.peak_rss_kb)
+			os << r.peak_rss_kb;
+		else
+			os << "-";
+		string status = status_of(r);
+		if (!baseline.empty()) {
+			const comparison c = compare_to(r, baseline, tolerance);
+			if (c.known) {
+				os << setw(10) << c.baseline_cpu << setw(8) << setprecision(1)
+				   << showpos << c.cpu_change << noshowpos << setprecision(3) << '%';
+				if (c.slower)
+					status += ", slower";
+				if (c.more_objects)
+					status += ", more objects";
+			} else
+				os << setw(10) << "-" << setw(9) << "-";
+		}
+		os << "  " << status << endl;
+	}
+	os.unsetf(ios::fixed);
+#ifndef HAVE_GETTIMEOFDAY
+	os << "(built without gettimeofday(): wall clock times are processor times)" << endl;
+#endif
+#ifndef HAVE_RUSAGE
+	os << "(built without getrusage(): peak memory is unknown)" << endl;
+#endif
+}
+
+static void print_csv(ostream& os, const vector<result>& results,
+                      const map<string, baseline_entry>& baseline, double tolerance)
+{
+	os << "name,size,runs,cpu_min,cpu_median,wall_min,wall_median,objects,peak_rss_kb,status";
+	if (!baseline.empty())
+		os << ",baseline_cpu_median,cpu_change_percent";
+	os << endl;
+
+	os << setprecision(6);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result& r = results[i];
+		os << r.name << ',';
+		if (r.size)
+			os << r.size;
+		os << ',' << r.cpu.size() << ',' << minimum(r.cpu) << ','
+		   << median(r.cpu) << ',' << minimum(r.wall) << ',' << median(r.wall) << ','
+		   << r.objects << ',' << r.peak_rss_kb << ',' << status_of(r);
+		if (!baseline.empty()) {
+			const comparison c = compare_to(r, baseline, tolerance);
+			if (c.known)
+				os << ',' << c.baseline_cpu << ',' << c.cpu_change;
+			else
+				os << ",,";
+		}
+		os << endl;
+	}
+}
+
+static void print_json_array(ostream& os, const vector<double>& v)
+{
+	os << '[';
+	for (size_t i = 0; i < v.size(); ++i)
+		os << (i ? ", " : "") << v[i];
+	os << ']';
+}
+
+static void print_json(ostream& os, const vector<result>& results,
+                       const map<string, baseline_entry>& baseline, double tolerance)
+{
+	os << setprecision(6) << "{\"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result& r = results[i];
+		os << (i ? "," : "") << "\n  {\"name\": \"" << r.name << '"';
+		if (r.size)
+			os << ", \"size\": " << r.size;
+		os << ", \"cpu\": ";
+		print_json_array(os, r.cpu);
+		os << ", \"wall\": ";
+		print_json_array(os, r.wall);
+		os << ", \"cpu_min\": " << minimum(r.cpu) << ", \"cpu_median\": " << median(r.cpu)
+		   << ", \"wall_min\": " << minimum(r.wall) << ", \"wall_median\": " << median(r.wall)
+		   << ", \"objects\": " << r.objects << ", \"peak_rss_kb\": " << r.peak_rss_kb
+		   << ", \"status\": \"" << status_of(r) << '"';
+		if (!baseline.empty()) {
+			const comparison c = compare_to(r, baseline, tolerance);
+			if (c.known)
+				os << ", \"baseline_cpu_median\": " << c.baseline_cpu
+				   << ", \"cpu_change_percent\": " << c.cpu_change
+				   << ", \"slower\": " << (c.slower ? "true" : "false")
+				   << ", \"more_objects\": " << (c.more_objects ? "true" : "false");
+		}
+		os << '}';
+	}
+	os << "\n]}" << endl;
+}
+
+/// Whether a name starts with one of the selected ones (or none was selected)
+static bool is_selected(const string& name, const vector<string>& selected)
+{
+	if (selected.empty())
+		return true;
+	for (size_t k = 0; k < selected.size(); ++k)
+		if (name.compare(0, selected[k].size(), selected[k]) == 0)
+			return true;
+	return false;
+}
+
+/// Parse a comma separated list of sizes
+static vector<unsigned> parse_sizes(const string& list)
+{
+	vector<unsigned> sizes;
+	istringstream is(list);
+	string item;
+	while (getline(is, item, ','))
+		if (atoi(item.c_str()) > 0)
+			sizes.push_back(atoi(item.c_str()));
+	return sizes;
+}
+
+static void usage(ostream& os)
+{
+	os << "Usage: bench [options] [benchmark...]\n"
+	      "Run the given benchmarks, or all of them.  A name selects every\n"
+	      "benchmark starting with it, e.g. \"lw\" selects lw_A to lw_Qprime.\n"
+	      "  -l, --list              list the benchmarks and sweeps\n"
+	      "  -s, --sweep             run the sweeps over sizes instead\n"
+	      "      --sizes N,N,...     sizes for the sweeps, instead of their own\n"
+	      "  -r, --repeat N          timed runs of each benchmark (3)\n"
+	      "  -w, --warmup N          untimed runs before them (1)\n"
+	      "  -f, --format FORMAT     text, json or csv (text)\n"
+	      "  -o, --output FILE       write the results to FILE\n"
+	      "  -b, --baseline FILE     compare with a CSV file written earlier\n"
+	      "  -t, --tolerance PERCENT slowdown counted as regression (10)\n"
+	      "  -v, --verbose           show the output of the benchmarks\n"
+	      "      --in-process        do not run the benchmarks in child processes\n"
+	      "The exit status is 1 if a benchmark failed or regressed." << endl;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned repeat = 3;
+	unsigned warmup = 1;
+	string format = "text";
+	string output;
+	string baseline_file;
+	double tolerance = 10;
+	bool verbose = false;
+	bool in_process = false;
+	bool sweep_sizes = false;
+	string sizes;
+	vector<string> selected;
+
+	for (int i = 1; i < argc; ++i) {
+		const string arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "-h" || arg == "--help") {
+			usage(cout);
+			return 0;
+		} else if (arg == "-l" || arg == "--list") {
+			for (unsigned j = 0; j < num_benchmarks; ++j)
+				cout << benchmarks[j].name << endl;
+			cout << endl << "sweeps:" << endl;
+			for (unsigned j = 0; j < num_sweeps; ++j)
+				cout << sweeps[j].name << ' ' << sweeps[j].sizes << endl;
+			return 0;
+		} else if (arg == "-s" || arg == "--sweep") {
+			sweep_sizes = true;
+		} else if (arg == "--sizes" && has_value) {
+			sizes = argv[++i];
+		} else if ((arg == "-r" || arg == "--repeat") && has_value) {
+			repeat = atoi(argv[++i]);
+		} else if ((arg == "-w" || arg == "--warmup") && has_value) {
+			warmup = atoi(argv[++i]);
+		} else if ((arg == "-f" || arg == "--format") && has_value) {
+			format = argv[++i];
+		} else if ((arg == "-o" || arg == "--output") && has_value) {
+			output = argv[++i];
+		} else if ((arg == "-b" || arg == "--baseline") && has_value) {
+			baseline_file = argv[++i];
+		} else if ((arg == "-t" || arg == "--tolerance") && has_value) {
+			tolerance = atof(argv[++i]);
+		} else if (arg == "-v" || arg == "--verbose") {
+			verbose = true;
+		} else if (arg == "--in-process") {
+			in_process = true;
+		} else if (!arg.empty() && arg[0] != '-') {
+			selected.push_back(arg);
+		} else {
+			usage(cerr);
+			return 2;
+		}
+	}
+	if (repeat == 0 || (format != "text" && format != "json" && format != "csv")) {
+		usage(cerr);
+		return 2;
+	}
+
+	vector<job> to_run;
+	if (sweep_sizes) {
+		for (unsigned j = 0; j < num_sweeps; ++j) {
+			if (!is_selected(sweeps[j].name, selected))
+				continue;
+			const vector<unsigned> v = parse_sizes(sizes.empty() ? sweeps[j].sizes : sizes);
+			for (size_t k = 0; k < v.size(); ++k) {
+				job b;
+				ostringstream name;
+				name << sweeps[j].name << ':' << v[k];
+				b.name = name.str();
+				b.run_sized = sweeps[j].run;
+				b.size = v[k];
+				to_run.push_back(b);
+			}
+		}
+	} else {
+		for (unsigned j = 0; j < num_benchmarks; ++j) {
+			if (!is_selected(benchmarks[j].name, selected))
+				continue;
+			job b;
+			b.name = benchmarks[j].name;
+			b.run = benchmarks[j].run;
+			to_run.push_back(b);
+		}
+	}
+	if (to_run.empty()) {
+		cerr << "bench: no such benchmark" << endl;
+		return 2;
+	}
+
+	map<string, baseline_entry> baseline;
+	if (!baseline_file.empty()) {
+		try {
+			read_baseline(baseline_file, baseline);
+		} catch (const exception& e) {
+			cerr << "bench: " << e.what() << endl;
+			return 2;
+		}
+	}
+
+	randomify_symbol_serials();
+
+	vector<result> results;
+	for (size_t j = 0; j < to_run.size(); ++j) {
+		clog << "running " << to_run[j].name << "..." << endl;
+		result r;
+		r.name = to_run[j].name;
+		r.size = to_run[j].size;
+#ifdef HAVE_RUSAGE
+		if (!in_process)
+			run_benchmark_isolated(to_run[j], warmup, repeat, verbose, r);
+		else
+#endif
+			run_benchmark(to_run[j], warmup, repeat, verbose, r);
+		results.push_back(r);
+	}
+
+	ofstream file;
+	if (!output.empty()) {
+		file.open(output.c_str());
+		if (!file) {
+			cerr << "bench: cannot write " << output << endl;
+			return 2;
+		}
+	}
+	ostream& os = output.empty() ? cout : file;
+	if (format == "json")
+		print_json(os, results, baseline, tolerance);
+	else if (format == "csv")
+		print_csv(os, results, baseline, tolerance);
+	else
+		print_text(os, results, baseline, tolerance);
+
+	int status = 0;
+	for (size_t j = 0; j < results.size(); ++j) {
+		const comparison c = compare_to(results[j], baseline, tolerance);
+		if (results[j].crashed || results[j].failures || c.slower || c.more_objects)
+			status = 1;
+	}
+	return status;
+}
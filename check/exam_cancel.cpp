@@ -0,0 +1,176 @@
+/** @file exam_cancel.cpp
+ *
+ *  Check that long computations can be cancelled in time. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ginac.h"
+using namespace GiNaC;
+
+#include <ctime>
+#include <iostream>
+using namespace std;
+
+static symbol x("x"), y("y"), z("z"), w("w");
+
+// Each of these takes far longer than the time budget given below.
+
+static ex long_expand()
+{
+	return expand(pow(x + y + z + w + 1, 40));
+}
+
+static ex long_gcd()
+{
+	ex p = expand(pow(x + y + z + w + 1, 15) * (x - 2*y + 3));
+	ex q = expand(pow(x - y + z - w + 1, 15) * (x - 2*y + 3) * (z + 5));
+	return gcd(p, q);
+}
+
+static ex long_normal()
+{
+	ex e;
+	for (int i = 1; i <= 200; ++i)
+		e += 1/(x + i*y + i*i*z + w/i);
+	return e.normal();
+}
+
+static ex long_factor()
+{
+	ex p = expand((pow(x, 12) + y*z*x + 2) * (pow(y, 12) + x*z + 3)
+	              * (pow(z, 12) + x*y + 5) * (pow(w, 12) + x*y*z + 7));
+	return factor(p);
+}
+
+static ex long_determinant()
+{
+	const unsigned n = 10;
+	matrix m(n, n);
+	for (unsigned r = 0; r < n; ++r)
+		for (unsigned c = 0; c < n; ++c)
+			m(r, c) = symbol();
+	return m.determinant(determinant_algo::laplace);
+}
+
+static ex long_series()
+{
+	return series(exp(sin(x) + pow(x, 2)*y) / (1 - x*z), x == 0, 400);
+}
+
+typedef ex (*computation)();
+
+/** Run f with a time budget of 0.1 seconds and check that it stops within
+ *  a second. */
+static unsigned check_cancellation(computation f, const char* name)
+{
+	const std::clock_t start = std::clock();
+	bool cancelled = false;
+	cancellation::set_timeout(0.1);
+	try {
+		f();
+	} catch (const computation_cancelled & e) {
+		cancelled = true;
+		if (e.polls() == 0) {
+			clog << name << ": cancelled without polling" << endl;
+			cancellation::reset();
+			return 1;
+		}
+	}
+	cancellation::reset();
+	const double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+	if (seconds > 1.0) {
+		clog << name << ": " << (cancelled ? "cancelled" : "finished")
+		     << " after " << seconds << "s (budget was 0.1s)" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+static unsigned cancel_on_timeout()
+{
+	unsigned result = 0;
+	result += check_cancellation(long_expand, "expand");
+	result += check_cancellation(long_gcd, "gcd");
+	result += check_cancellation(long_normal, "normal");
+	result += check_cancellation(long_factor, "factor");
+	result += check_cancellation(long_determinant, "determinant");
+	result += check_cancellation(long_series, "series");
+	return result;
+}
+
+static unsigned cancel_on_request()
+{
+	unsigned result = 0;
+
+	cancellation::request();
+	try {
+		long_expand();
+		clog << "expand() was not cancelled on request" << endl;
+		++result;
+	} catch (const computation_cancelled & e) {
+		if (string(e.site()) != "expand") {
+			clog << "cancellation noticed in " << e.site() << " instead of expand" << endl;
+			++result;
+		}
+	}
+
+	// Further computations are cancelled as well...
+	try {
+		long_series();
+		clog << "cancellation was forgotten after the first exception" << endl;
+		++result;
+	} catch (const computation_cancelled &) {
+	}
+
+	// ...until the cancellation is reset
+	cancellation::reset();
+	try {
+		ex e = expand(pow(x + y, 3));
+		if (!e.is_equal(expand(pow(x + y, 2) * (x + y)))) {
+			clog << "expand() gives " << e << " after reset" << endl;
+			++result;
+		}
+	} catch (const computation_cancelled &) {
+		clog << "expand() cancelled after reset" << endl;
+		++result;
+	}
+	if (cancellation::is_armed()) {
+		clog << "cancellation still armed after reset" << endl;
+		++result;
+	}
+	return result;
+}
+
+unsigned exam_cancel()
+{
+	unsigned result = 0;
+
+	cout << "examining cancellation of computations" << flush;
+
+	result += cancel_on_timeout();  cout << '.' << flush;
+	result += cancel_on_request();  cout << '.' << flush;
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	return exam_cancel();
+}
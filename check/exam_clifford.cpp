@@ -226,6 +226,25 @@ static unsigned clifford_check3()
 	e = dirac_trace(e).simplify_indexed(sp);
 	result += check_equal(e, 4*(2*ldotq*ldotq + q*q*ldotq - q*q*l*l + q*q*m*m).expand());
 
+	// longer traces, using the scalar products right away
+	e = dirac_slash(q, dim) * dirac_slash(l, dim) * dirac_slash(q, dim) * dirac_slash(l, dim);
+	result += check_equal(dirac_trace(e, 0, sp), 4*(2*ldotq*ldotq - q*q*l*l));
+
+	e = dirac_ONE();
+	for (int i=0; i<12; i++)
+		e = e * dirac_slash(q, dim);
+	result += check_equal(dirac_trace(e, 0, sp), 4*pow(q, 12));
+
+	e = dirac_slash(q, dim) * dirac_gamma(mu) * dirac_slash(l, dim) * dirac_gamma(nu)
+	  * dirac_slash(q, dim) * dirac_gamma(mu.toggle_variance()) * dirac_slash(l, dim)
+	  * dirac_gamma(nu.toggle_variance());
+	result += check_equal(dirac_trace(e, 0, sp), dirac_trace(e).simplify_indexed(sp));
+
+	e = dirac_gamma5() * dirac_slash(q, dim) * dirac_gamma(mu) * dirac_slash(l, dim)
+	  * dirac_gamma(nu) * dirac_gamma(rho) * dirac_gamma(mu.toggle_variance());
+	result += check_equal(dirac_trace(e, 0, sp).simplify_indexed(sp),
+	                      dirac_trace(e).simplify_indexed(sp));
+
 	// stuff that had problems in the past
 	ex prop = dirac_slash(q, dim) - m * dirac_ONE();
 	e = dirac_slash(l, dim) * dirac_gamma5() * dirac_slash(l, dim) * prop;
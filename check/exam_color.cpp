@@ -144,6 +144,43 @@ static unsigned color_check3()
 	return result;
 }
 
+static unsigned color_check4()
+{
+	// checks traces for SU(N)
+
+	unsigned result = 0;
+
+	symbol N("N");
+	idx a(symbol("a"), 8), b(symbol("b"), 8), c(symbol("c"), 8), d(symbol("d"), 8), k(symbol("k"), 8);
+	ex e;
+
+	e = color_ONE();
+	result += check_equal(color_trace(e, 0, N), N);
+	e = color_T(a);
+	result += check_equal(color_trace(e, 0, N), 0);
+	e = color_T(a) * color_T(b);
+	result += check_equal(color_trace(e, 0, N), delta_tensor(a, b) / 2);
+	e = color_T(a) * color_T(a);
+	result += check_equal(color_trace(e, 0, N), (pow(N, 2) - 1) / 2);
+	e = color_T(a) * color_T(b) * color_T(a) * color_T(b);
+	result += check_equal(color_trace(e, 0, N), (-(pow(N, 2) - 1) / (4 * N)).expand());
+	e = color_T(a) * color_T(b) * color_T(b) * color_T(a);
+	result += check_equal(color_trace(e, 0, N), (pow(pow(N, 2) - 1, 2) / (4 * N)).expand());
+	e = color_T(a) * color_T(b) * color_T(c) * color_T(c);
+	result += check_equal(color_trace(e, 0, N), ((pow(N, 2) - 1) / (4 * N) * delta_tensor(a, b)).expand());
+	e = color_T(a) * color_T(b) * color_T(a) * color_T(c);
+	result += check_equal(color_trace(e, 0, N), -delta_tensor(b, c) / (4 * N));
+
+	// for N = 3 they must agree with the SU(3) traces
+	e = color_T(a) * color_T(b) * color_T(c) * color_T(k) * color_T(a) * color_T(k) * color_T(c) * color_T(b);
+	result += check_equal(color_trace(e, 0, N).subs(N == 3), numeric(-1, 54));
+	result += check_equal_simplify(color_trace(e), numeric(-1, 54));
+	e = color_T(a) * color_T(b) * color_T(c) * color_T(d) * color_T(a) * color_T(b) * color_T(c) * color_T(d);
+	result += check_equal(color_trace(e, 0, 3), simplify_indexed(color_trace(e)));
+
+	return result;
+}
+
 unsigned exam_color()
 {
 	unsigned result = 0;
@@ -153,6 +190,7 @@ unsigned exam_color()
 	result += color_check1();  cout << '.' << flush;
 	result += color_check2();  cout << '.' << flush;
 	result += color_check3();  cout << '.' << flush;
+	result += color_check4();  cout << '.' << flush;
 	
 	return result;
 }
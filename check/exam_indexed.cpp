@@ -226,6 +226,26 @@ static unsigned scalar_product_check()
 	e = indexed(A, i, i) * indexed(B, j, j); // GiNaC 0.8.0 had a bug here
 	result += check_equal_simplify(e, e, sp);
 
+	// the dummy indices of simplify_indexed() on a list are named consistently
+	exvector v;
+	v.push_back((indexed(A + B, i) * indexed(A + C, i)).expand(expand_options::expand_indexed));
+	v.push_back(indexed(B, j) * indexed(C, j) + indexed(A, j) * indexed(A, j));
+	v = simplify_indexed(v, sp);
+	result += check_equal(v[0], indexed(B, i) * indexed(C, i) + 4);
+	result += check_equal(v[0], v[1]);
+
+	// ...but they never capture a free index of a later expression
+	v.clear();
+	v.push_back(indexed(A, i, i));
+	v.push_back(indexed(B, i) * indexed(C, j, j));
+	v = simplify_indexed(v, sp);
+	result += check_equal(v[1], (indexed(B, i) * indexed(C, j, j)).simplify_indexed(sp));
+	v.clear();
+	v.push_back(indexed(A, i, i) * indexed(B, j, j));
+	v.push_back(indexed(C, i, j) - indexed(C, j, i));
+	v = simplify_indexed(v, sp);
+	result += check_equal(v[1], indexed(C, i, j) - indexed(C, j, i));
+
 	return result;
 }
 
@@ -379,6 +399,19 @@ static unsigned dummy_check()
 	e = indexed(p, mu.toggle_variance(), mu) - indexed(p, nu, nu.toggle_variance());
 	result += check_equal_simplify(e, 0);
 
+	// terms that only differ in the names of many dummy indices
+	symbol A("A"), B("B");
+	idx k(symbol("k"), 3), l(symbol("l"), 3), m(symbol("m"), 3);
+	e = indexed(A, i, j) * indexed(A, j, k) * indexed(A, k, l) * indexed(A, l, m) * indexed(B, m, i)
+	  - indexed(A, j, k) * indexed(A, k, l) * indexed(A, l, m) * indexed(A, m, i) * indexed(B, i, j);
+	result += check_equal_simplify(e, 0);
+	e = indexed(A, i, j) * indexed(B, sy_anti(), j, k) * indexed(p, k) * indexed(q, i)
+	  + indexed(A, l, m) * indexed(B, sy_anti(), k, m) * indexed(p, k) * indexed(q, l);
+	result += check_equal_simplify(e, 0);
+	e = indexed(A, k, k) * indexed(B, i, i) * indexed(p, j) * indexed(q, j)
+	  - indexed(A, i, i) * indexed(B, j, j) * indexed(p, k) * indexed(q, k);
+	result += check_equal_simplify(e, 0);
+
 	// GiNaC 1.2.1 had a bug here because p.i*p.i -> (p.i)^2
 	e = indexed(p, i) * indexed(p, i) * indexed(p, j) + indexed(p, j);
 	ex fi = exprseq(e.get_free_indices());
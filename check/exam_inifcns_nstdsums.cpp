@@ -24,6 +24,7 @@
 #include "ginac.h"
 using namespace GiNaC;
 
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 using namespace std;
@@ -110,6 +111,19 @@ static unsigned inifcns_test_S()
 		}
 	}
 
+	// the lookup tables for different precisions must not get mixed up
+	prepare_polylog_tables(8);
+	ex s22 = S(3, 4, numeric(1,3)).evalf();
+	Digits = 40;
+	ex s40 = S(3, 4, numeric(1,3)).evalf();
+	Digits = 22;
+	ex s22again = S(3, 4, numeric(1,3)).evalf();
+	if (abs(s40-s22) > prec || !s22again.is_equal(s22)) {
+		clog << "S(3,4,1/3) differs after changing Digits: " << s22 << ", "
+		     << s40 << ", " << s22again << endl;
+		result++;
+	}
+
 	Digits = digitsbuf;
 
 	return result;
@@ -277,6 +291,12 @@ static unsigned inifcns_test_LiG()
 			- G(lst(1.51,-0.999,sqrt(numeric(1)/2)+I*sqrt(numeric(1)/2)),1).hold());
 	// checks for hoelder convolution which is used if one argument has a distance to one smaller than 0.01 
 	res.append(G(lst(0, 1.2, 1, 1.01), 1).hold() - G(lst(0, 1.2, 1, numeric("1.009999999999999999")), 1).hold());
+	// checks for the convergence transformation with negative arguments, which give negative
+	// arguments of logarithms and negative bases of powers in the transformed expression
+	res.append(G(lst(-1),3).hold() - log(numeric(4)));
+	res.append(G(lst(-1,-1),3).hold() - pow(log(numeric(4)),2)/2);
+	res.append(G(lst(-2,-2,-2),3).hold() - pow(log(numeric(5,2)),3)/6);
+	res.append(G(lst(-1),3).hold() * G(lst(-2),3).hold() - G(lst(-1,-2),3).hold() - G(lst(-2,-1),3).hold());
 
 	for (lst::const_iterator it = res.begin(); it != res.end(); it++) {
 		ex diff = abs((*it).evalf());
@@ -287,6 +307,17 @@ static unsigned inifcns_test_LiG()
 		cout << "." << flush;
 	}
 
+	// evaluating all of them together must give the same values
+	exvector exprs(res.begin(), res.end());
+	exvector batch = G_evalf_batch(exprs);
+	for (size_t i = 0; i < exprs.size(); ++i) {
+		ex diff = abs(batch[i] - exprs[i].evalf());
+		if (diff > prec) {
+			clog << "G_evalf_batch: " << exprs[i] << " evaluates differently: " << diff << endl;
+			result++;
+		}
+	}
+
 	return result;
 }
 
@@ -366,6 +397,119 @@ static unsigned inifcns_test_legacy()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//  double precision summation (used for Digits <= 14)
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_double()
+{
+	int digitsbuf = Digits;
+	unsigned result = 0;
+
+	lst fcns;
+	fcns.append(Li(2, numeric(3,10)));
+	fcns.append(Li(2, numeric(-7,10)));
+	fcns.append(Li(3, numeric(6,10)));
+	fcns.append(Li(5, numeric(-2,5)+numeric(1,5)*I));
+	fcns.append(Li(lst(2,1), lst(numeric(3,10), numeric(1,2))));
+	fcns.append(Li(lst(1,1,2), lst(numeric(-1,3), numeric(1,4)*I, 2)));
+	fcns.append(S(2, 3, numeric(2,5)));
+	fcns.append(S(1, 4, numeric(-3,10)));
+	fcns.append(H(lst(2,1,1), numeric(3,10)));
+	fcns.append(H(lst(1,-2), numeric(7,10)));
+	fcns.append(zeta(lst(3,2)));
+	fcns.append(zeta(lst(7,2)));
+	fcns.append(zeta(lst(2,1,1),lst(-1,1,-1)));
+	fcns.append(G(lst(numeric(3,10), 0, numeric(7,10)), 1));
+
+	for (lst::const_iterator it = fcns.begin(); it != fcns.end(); ++it) {
+		Digits = 30;
+		ex exact = it->evalf();
+		Digits = 14;
+		ex fast = it->evalf();
+		if (!is_a<numeric>(fast) || abs(fast - exact) > 1e-11 * abs(exact)) {
+			clog << *it << " with Digits=14 gives " << fast << " instead of " << exact << endl;
+			result++;
+		}
+		cout << "." << flush;
+	}
+
+	Digits = digitsbuf;
+
+	return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//  persistent evalf cache
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+static unsigned inifcns_test_cache()
+{
+	Digits = 40;
+	const char * filename = "exam_inifcns_nstdsums.cache";
+	std::remove(filename);
+
+	unsigned result = 0;
+
+	ex e = Li(lst(2,1),lst(numeric(1,3),numeric(-1,2))).hold()
+	     + H(lst(2,-1),numeric(1,5)).hold()
+	     + zeta(lst(3,2)).hold();
+	ex r1 = e.evalf();
+
+	evalf_cache::open(filename);
+	ex r2 = e.evalf();
+	const size_t entries = evalf_cache::size();
+	if (entries < 3 || !r1.is_equal(r2)) {
+		clog << "evalf cache: storing " << e << " gave " << r2 << " with "
+		     << entries << " entries instead of " << r1 << endl;
+		++result;
+	}
+
+	// Values read back from the file must be the same
+	evalf_cache::close();
+	evalf_cache::open(filename);
+	ex r3 = e.evalf();
+	if (evalf_cache::size() != entries || !r1.is_equal(r3)) {
+		clog << "evalf cache: reading " << e << " gave " << r3 << " with "
+		     << evalf_cache::size() << " entries instead of " << r1 << endl;
+		++result;
+	}
+
+	// Another precision is another entry
+	Digits = 20;
+	ex r4 = zeta(3).evalf();
+	if (evalf_cache::size() != entries + 1 || abs(r4 - zeta(3).evalf()) > pow(10, -18)) {
+		clog << "evalf cache: zeta(3) with Digits=20 not stored properly" << endl;
+		++result;
+	}
+
+	// A size limit keeps the file small
+	evalf_cache::clear();
+	evalf_cache::close();
+	evalf_cache::open(filename, 1000);
+	for (int i = 2; i < 40; ++i)
+		zeta(i+1).evalf();
+	ifstream f(filename, ios::in | ios::binary);
+	f.seekg(0, ios::end);
+	if (f.tellg() > 1000) {
+		clog << "evalf cache: file grew to " << f.tellg() << " bytes despite limit" << endl;
+		++result;
+	}
+	f.close();
+
+	evalf_cache::close();
+	std::remove(filename);
+	return result;
+}
+
+
 unsigned exam_inifcns_nstdsums(void)
 {
 	unsigned result = 0;
@@ -377,6 +521,8 @@ unsigned exam_inifcns_nstdsums(void)
 	result += inifcns_test_HLi();
 	result += inifcns_test_LiG();
 	result += inifcns_test_legacy();
+	result += inifcns_test_double();
+	result += inifcns_test_cache();
 	
 	return result;
 }
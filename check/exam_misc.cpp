@@ -24,6 +24,7 @@
 using namespace GiNaC;
 
 #include <iostream>
+#include <sstream>
 using namespace std;
 
 #define VECSIZE 30
@@ -235,6 +236,24 @@ static unsigned exam_subs()
 		++result;
 	}
 
+	// Subexpressions shared between several parts of an expression must be
+	// substituted only once (this would take forever otherwise), and the
+	// result must share them in the same way
+	symbol y("y");
+	e1 = x;
+	for (int i=0; i<40; ++i)
+		e1 = sin(e1) + cos(e1);
+	e2 = e1.subs(x == y);
+	if (!are_ex_trivially_equal(e2.op(0).op(0), e2.op(1).op(0))) {
+		clog << "subs() on an expression with shared subexpressions did not preserve sharing" << endl;
+		++result;
+	}
+	e2 = e1.subs(sin(wild()) == tan(wild()));
+	if (!are_ex_trivially_equal(e2.op(0).op(0), e2.op(1).op(0))) {
+		clog << "subs() with patterns on an expression with shared subexpressions did not preserve sharing" << endl;
+		++result;
+	}
+
 	return result;
 }
 
@@ -298,6 +317,271 @@ static unsigned exam_subs_algebraic()
 	return result;
 }
 
+/* Check that prepared_subs gives the same results as subs(). */
+static unsigned exam_prepared_subs()
+{
+	unsigned result = 0;
+	symbol x("x"), y("y"), z("z");
+
+	ex e = sin(x)*y + pow(cos(x)+z, 2) + exp(Pi) + pow(x, y) + x*y;
+	prepared_subs ps(e, lst(x, y));
+
+	for (int i=1; i<5; ++i) {
+		lst values(numeric(i, 3), i-2);
+		ex r1 = ps.subs(values);
+		ex r2 = e.subs(lst(x == values.op(0), y == values.op(1)), subs_options::no_pattern);
+		if (!r1.is_equal(r2)) {
+			clog << "prepared_subs returned " << r1 << " instead of " << r2 << endl;
+			++result;
+		}
+		ex n1 = ps.evalf(values).subs(z == 2).evalf();
+		ex n2 = r2.subs(z == 2).evalf();
+		ex diff = abs(n1 - n2).evalf();
+		if (!is_a<numeric>(diff) || ex_to<numeric>(diff) > numeric(1, 1000000)) {
+			clog << "prepared_subs::evalf() returned " << n1 << " instead of " << n2 << endl;
+			++result;
+		}
+	}
+
+	// Negative bases must not pick up complex branches from exponents that
+	// are evaluated to floating point numbers
+	ex f = pow(x, 2)*z + pow(x-y, 3) + pow(x, y) + pow(x, y+1)*sin(y) + sqrt(x) + pow(z, y+3);
+	prepared_subs fs(f, lst(x, y));
+	for (int i=1; i<4; ++i) {
+		lst values(numeric(-2*i-1, 2), i-2);
+		ex n1 = fs.evalf(values);
+		ex n2 = f.subs(lst(x == values.op(0), y == values.op(1)), subs_options::no_pattern).evalf();
+		ex diff = abs((n1 - n2).subs(z == -2).evalf()).evalf();
+		if (!is_a<numeric>(diff) || ex_to<numeric>(diff) > numeric(1, 1000000)
+		 || n1.expand().degree(z) != n2.expand().degree(z)) {
+			clog << "prepared_subs::evalf() returned " << n1 << " instead of " << n2 << endl;
+			++result;
+		}
+	}
+
+	// Substituting the symbols by other symbols
+	ex r = ps.subs(lst(y, x));
+	ex r2 = e.subs(lst(x == y, y == x), subs_options::no_pattern);
+	if (!r.is_equal(r2)) {
+		clog << "prepared_subs returned " << r << " instead of " << r2 << endl;
+		++result;
+	}
+
+	return result;
+}
+
+/* Check matching of sums and products where the first match of a term is not
+ * the right one, and matching against sets of patterns. */
+static unsigned exam_match()
+{
+	unsigned result = 0;
+	symbol x("x"), y("y"), z("z");
+
+	// Whichever sine is tried first, one of these needs to back up
+	ex e1 = sin(x)*sin(y)*cos(y), e2 = sin(x)*sin(y)*cos(x);
+	ex pattern = sin(wild(0))*cos(wild(0))*wild(1);
+	exmap repls;
+	if (!e1.match(pattern, repls) || !repls[wild(0)].is_equal(y) || !repls[wild(1)].is_equal(sin(x))) {
+		clog << e1 << " did not match " << pattern << " with $0==y, $1==sin(x)" << endl;
+		++result;
+	}
+	repls.clear();
+	if (!e2.match(pattern, repls) || !repls[wild(0)].is_equal(x) || !repls[wild(1)].is_equal(sin(y))) {
+		clog << e2 << " did not match " << pattern << " with $0==x, $1==sin(y)" << endl;
+		++result;
+	}
+	repls.clear();
+	if (!e1.match(sin(wild(1))*sin(wild(0))*cos(wild(0)), repls) || !repls[wild(1)].is_equal(x)) {
+		clog << e1 << " did not match sin($1)*sin($0)*cos($0) with $1==x" << endl;
+		++result;
+	}
+	ex e = e1.subs(pattern == wild(0)*wild(1));
+	if (!e.is_equal(y*sin(x))) {
+		clog << e1 << ".subs(" << pattern << "==$0*$1) erroneously returned " << e << endl;
+		++result;
+	}
+
+	pattern_set rules(lst(sin(wild())*cos(wild()), pow(sin(wild()), 2), cos(x)));
+	size_t which;
+	repls.clear();
+	if (!(sin(y)*cos(y)).match(rules, repls, which) || which != 0 || !repls[wild()].is_equal(y)) {
+		clog << "sin(y)*cos(y) did not match the first pattern of a set" << endl;
+		++result;
+	}
+	repls.clear();
+	if (!pow(sin(x+1), 2).match(rules, repls, which) || which != 1 || !repls[wild()].is_equal(x+1)) {
+		clog << "sin(x+1)^2 did not match the second pattern of a set" << endl;
+		++result;
+	}
+	repls.clear();
+	if (!ex(cos(x)).match(rules, repls, which) || which != 2 || ex(cos(y)).match(rules, repls, which)) {
+		clog << "cos(x) and cos(y) were not told apart by a set of patterns" << endl;
+		++result;
+	}
+
+	if (!ex(exp(pow(sin(y), 2)+1)).has(rules) || ex(exp(sin(y)+cos(z))).has(rules)) {
+		clog << "has() with a set of patterns returned wrong results" << endl;
+		++result;
+	}
+	if (!(x+3).has(pattern_set(lst(-3)))) {
+		clog << "(x+3).has() with a set of patterns does not find -3 like (x+3).has(-3)" << endl;
+		++result;
+	}
+
+	exset found;
+	e = pow(sin(y), 2) + sin(z)*cos(z) + cos(x)*y;
+	if (!e.find(rules, found) || found.size() != 3
+	 || !found.count(pow(sin(y), 2)) || !found.count(sin(z)*cos(z)) || !found.count(cos(x))) {
+		clog << "find() with a set of patterns in " << e << " returned " << exprseq(exvector(found.begin(), found.end())) << endl;
+		++result;
+	}
+
+	return result;
+}
+
+/* Check numerical integration, including integrands with arguments that
+ * don't evaluate to numbers. */
+static unsigned exam_integral()
+{
+	unsigned result = 0;
+	symbol x("x");
+
+	const ex integrals[] = {
+		integral(x, 0, 1, pow(x, 2)),
+		integral(x, 0, Pi, sin(x)),
+		integral(x, 0, numeric(1, 2), H(lst(1), x)),
+		integral(x, -1, 1, exp(2*x)*x)
+	};
+	const ex values[] = {
+		numeric(1, 3),
+		2,
+		log(numeric(1, 2))/2 + numeric(1, 2),
+		(exp(ex(2)) + 3*exp(ex(-2)))/4
+	};
+	for (size_t i=0; i<sizeof(integrals)/sizeof(integrals[0]); ++i) {
+		ex r = integrals[i].evalf();
+		ex diff = abs(r - values[i]).evalf();
+		if (!is_a<numeric>(diff) || ex_to<numeric>(diff) > numeric(1, 1000000)) {
+			clog << integrals[i] << " was evaluated to " << r << " instead of " << values[i].evalf() << endl;
+			++result;
+		}
+	}
+
+	return result;
+}
+
+/* Test the remember option of functions. */
+static unsigned remember_test_evaluations = 0;
+
+DECLARE_FUNCTION_1P(remember_test)
+
+static ex remember_test_eval(const ex & x)
+{
+	++remember_test_evaluations;
+	return remember_test(x).hold();
+}
+
+REGISTER_FUNCTION(remember_test, eval_func(remember_test_eval).
+                                 remember(4, 2, remember_strategies::delete_lru))
+
+static unsigned exam_remember()
+{
+	unsigned result = 0;
+	symbol x("x");
+
+	// The function objects have to be converted to ex to be evaluated
+	remember_test_evaluations = 0;
+	ex r = remember_test(x);
+	r = remember_test(x);
+	if (remember_test_evaluations != 1) {
+		clog << "remembered function was evaluated " << remember_test_evaluations
+		     << " times instead of once" << endl;
+		++result;
+	}
+
+	// Filling the table must not lose the most recently used entry of a slot
+	for (int i=0; i<100; ++i) {
+		r = remember_test(x);
+		r = remember_test(pow(x, i+2));
+	}
+	if (remember_test_evaluations != 101) {
+		clog << "remembered function was evaluated " << remember_test_evaluations
+		     << " times instead of 101 times" << endl;
+		++result;
+	}
+
+	// A tiny memory limit discards all entries
+	function::set_remember_memory_limit(1);
+	r = remember_test(x);
+	function::set_remember_memory_limit(0);
+	if (remember_test_evaluations != 102) {
+		clog << "remembered function was evaluated " << remember_test_evaluations
+		     << " times instead of 102 times" << endl;
+		++result;
+	}
+
+	// The memory limit also counts the objects of the arguments
+	function::set_remember_memory_limit(4096);
+	const ex big = expand(pow(x+1, 100));
+	r = remember_test(big);
+	r = remember_test(big);
+	function::set_remember_memory_limit(0);
+	if (remember_test_evaluations != 104) {
+		clog << "remembered function was evaluated " << remember_test_evaluations
+		     << " times instead of 104 times" << endl;
+		++result;
+	}
+
+	return result;
+}
+
+static unsigned exam_profiler()
+{
+	unsigned result = 0;
+	symbol x("x"), y("y");
+	ex e = pow(x + y, 10);
+
+	profiler::reset();
+	e.expand();
+	if (profiler::calls(profiled_ops::expand) != 0) {
+		clog << "disabled profiler counted " << profiler::calls(profiled_ops::expand)
+		     << " calls of expand()" << endl;
+		++result;
+	}
+
+	profiler::enable();
+	e.expand();
+	gcd(expand(e * (x - 1)), expand(e * (y + 2)));
+	profiler::disable();
+	if (profiler::calls(profiled_ops::expand) == 0 || profiler::objects(profiled_ops::expand) == 0) {
+		clog << "profiler did not record expand()" << endl;
+		++result;
+	}
+	if (profiler::calls(profiled_ops::gcd) == 0 || profiler::calls(profiled_ops::compare) == 0) {
+		clog << "profiler did not record gcd() or compare()" << endl;
+		++result;
+	}
+
+	// Printing the report leaves the format of the stream alone
+	std::ostringstream os;
+	os.precision(10);
+	const std::ios::fmtflags flags = os.flags();
+	profiler::print(os);
+	if (os.flags() != flags || os.precision() != 10) {
+		clog << "profiler::print() changed the format of the stream" << endl;
+		++result;
+	}
+
+	profiler::reset();
+	for (unsigned op = 0; op < profiled_ops::num_ops; ++op) {
+		if (profiler::calls(op) != 0 || profiler::seconds(op) != 0 || profiler::objects(op) != 0) {
+			clog << "profiler::reset() did not clear " << profiler::name(op) << endl;
+			++result;
+		}
+	}
+	return result;
+}
+
 unsigned exam_misc()
 {
 	unsigned result = 0;
@@ -312,6 +596,11 @@ unsigned exam_misc()
 	result += exam_subs(); cout << '.' << flush;
 	result += exam_joris(); cout << '.' << flush;
 	result += exam_subs_algebraic(); cout << '.' << flush;
+	result += exam_prepared_subs(); cout << '.' << flush;
+	result += exam_match(); cout << '.' << flush;
+	result += exam_integral(); cout << '.' << flush;
+	result += exam_remember(); cout << '.' << flush;
+	result += exam_profiler(); cout << '.' << flush;
 	
 	return result;
 }
@@ -167,6 +167,61 @@ static unsigned exam_normal4()
 	return result;
 }
 
+static unsigned check_normal_sum(const ex &e, const ex &d)
+{
+	unsigned result = 0;
+	const unsigned options[] = { normal_options::sequential_sum, normal_options::balanced_sum, 0 };
+	for (unsigned i = 0; i < sizeof(options)/sizeof(options[0]); ++i) {
+		ex en = e.normal(0, options[i]);
+		if (!(en - d).normal().is_zero()) {
+			clog << "normal form of " << e << " with options " << options[i]
+			     << " erroneously returned " << en << " (should be " << d << ")" << endl;
+			++result;
+		}
+	}
+	return result;
+}
+
+static unsigned exam_normal5()
+{
+	unsigned result = 0;
+	ex e, d;
+
+	// Telescoping sum, long enough for the balanced summation
+	e = 0;
+	for (int i = 1; i <= 24; ++i)
+		e += 1/(x+i) - 1/(x+i+1);
+	d = numeric(24)/((x+1)*(x+25));
+	result += check_normal_sum(e, d);
+
+	// Many fractions with the same few denominators
+	e = 0;
+	for (int i = 1; i <= 30; ++i)
+		e += i*pow(y, i%4)/(x+(i%3));
+	d = 0;
+	for (int k = 0; k < 3; ++k) {
+		ex num = 0;
+		for (int i = 1; i <= 30; ++i)
+			if (i%3 == k)
+				num += i*pow(y, i%4);
+		d += num/(x+k);
+	}
+	result += check_normal_sum(e, d);
+
+	// Unexpanded numerators and symbols which are not polynomial
+	e = 0;
+	d = 0;
+	for (int i = 1; i <= 20; ++i) {
+		e += pow(x+y+sin(z), i%3+1)*(y-i)/(x-i) - pow(x+y+sin(z), i%3+1)/(x-i);
+		d += pow(x+y+sin(z), i%3+1)*(y-i-1)/(x-i);
+	}
+	e += numeric(1, 3)/(x+y);
+	d += numeric(1, 3)/(x+y);
+	result += check_normal_sum(e, d);
+
+	return result;
+}
+
 /* Test content(), integer_content(), primpart(). */
 static unsigned check_content(const ex & e, const ex & x, const ex & ic, const ex & c, const ex & pp)
 {
@@ -228,6 +283,7 @@ unsigned exam_normalization()
 	result += exam_normal2(); cout << '.' << flush;
 	result += exam_normal3(); cout << '.' << flush;
 	result += exam_normal4(); cout << '.' << flush;
+	result += exam_normal5(); cout << '.' << flush;
 	result += exam_content(); cout << '.' << flush;
 	
 	return result;
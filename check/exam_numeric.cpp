@@ -381,6 +381,46 @@ static unsigned exam_numeric6()
 	return result;
 }
 
+/* This test checks that small integers, which have shared objects, come out
+   right in arithmetic, also at the edge of their range. */
+static unsigned exam_numeric7()
+{
+	unsigned result = 0;
+
+	symbol x("x");
+	ex e1, e2;
+
+	e1 = ex(1000) + ex(24);
+	e2 = 1024;
+	if (!are_ex_trivially_equal(e1, e2)) {
+		clog << e1 << " and " << e2 << " erroneously do not share an object" << endl;
+		++result;
+	}
+	e1 = ex(1024) + 1;
+	if (!e1.is_equal(numeric(1025)) || !is_exactly_a<numeric>(e1)) {
+		clog << "1024+1 erroneously returned " << e1 << endl;
+		++result;
+	}
+	e1 = ex(-1024) - 1;
+	if (!e1.is_equal(numeric(-1025))) {
+		clog << "-1024-1 erroneously returned " << e1 << endl;
+		++result;
+	}
+	e1 = ex(numeric(2050)) / 2;
+	if (!e1.is_equal(numeric(1025))) {
+		clog << "2050/2 erroneously returned " << e1 << endl;
+		++result;
+	}
+	e1 = (3*x + 7*pow(x, 2)) * 146 - 1022 * pow(x, 2);
+	e2 = 438*x;
+	if (!(e1.expand() - e2).is_zero()) {
+		clog << "(3*x+7*x^2)*146-1022*x^2 erroneously returned " << e1.expand() << endl;
+		++result;
+	}
+
+	return result;
+}
+
 unsigned exam_numeric()
 {
 	unsigned result = 0;
@@ -393,6 +433,7 @@ unsigned exam_numeric()
 	result += exam_numeric4();  cout << '.' << flush;
 	result += exam_numeric5();  cout << '.' << flush;
 	result += exam_numeric6();  cout << '.' << flush;
+	result += exam_numeric7();  cout << '.' << flush;
 	
 	return result;
 }
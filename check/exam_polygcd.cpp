@@ -25,6 +25,7 @@
 using namespace GiNaC;
 
 #include <iostream>
+#include <stdexcept>
 using namespace std;
 
 const int MAX_VARIABLES = 3;
@@ -230,6 +231,96 @@ static unsigned poly_gcd7()
 	return 0;
 }
 
+// Sparse inputs in many variables, the GCD has large coefficients
+static unsigned poly_gcd_sparse()
+{
+	unsigned result = 0;
+	symbol a("a"), b("b"), c("c"), d("d"), e("e");
+	ex g = 123456789*pow(x, 3)*pow(a, 2)*e - 987654321*b*pow(c, 4) + z*pow(d, 5) - 42;
+	ex p = pow(x, 4)*b*d - 5*pow(a, 3)*pow(e, 2) + 7*c*z + 1;
+	ex q = pow(z, 3)*pow(b, 2) + 11*x*c*pow(d, 2) - a*pow(e, 6) - 13;
+	ex f1 = expand(g*p);
+	ex f2 = expand(g*q);
+	ex f3 = expand(p*q);
+
+	for (int i=0; i<2; i++) {
+		const unsigned options = i ? gcd_options::use_sparse_gcd : 0;
+		ex r = gcd(f1, f2, NULL, NULL, true, options);
+		if (!(r - g).expand().is_zero() && !(r + g).expand().is_zero()) {
+			clog << "sparse case, gcd(" << f1 << "," << f2 << ") = " << r << " (should be " << g << ")" << endl;
+			++result;
+		}
+		r = gcd(f1 * 6, f3 * 4, NULL, NULL, true, options);
+		if (!(r - 2*p).expand().is_zero() && !(r + 2*p).expand().is_zero()) {
+			clog << "sparse case, gcd(" << f1 * 6 << "," << f3 * 4 << ") = " << r << " (should be " << 2*p << ")" << endl;
+			++result;
+		}
+	}
+	return result;
+}
+
+// Cached results must be the same as computed ones, including cofactors
+static unsigned poly_gcd_cache()
+{
+	unsigned result = 0;
+	symbol y("y");
+	ex p = x - y * z + 1;
+	ex q = x - y + z * 3;
+	ex f = expand(pow(p, 2) * q);
+	ex g = expand(p * pow(q, 3));
+
+	ex ca0, cb0;
+	ex r0 = gcd(f, g, &ca0, &cb0);
+
+	gcd_cache::enable(1 << 20);
+	for (int i=0; i<3; i++) {
+		ex ca, cb;
+		ex r = (i == 1) ? gcd(f, g) : gcd(f, g, &ca, &cb);
+		if (!r.is_equal(r0) || (i != 1 && (!ca.is_equal(ca0) || !cb.is_equal(cb0)))) {
+			clog << "cached gcd(" << f << "," << g << ") = " << r << " with cofactors "
+			     << ca << ", " << cb << " (should be " << r0 << " with cofactors "
+			     << ca0 << ", " << cb0 << ")" << endl;
+			++result;
+		}
+	}
+	if (gcd_cache::size() == 0) {
+		clog << "gcd() results were not cached" << endl;
+		++result;
+	}
+
+	// A result cached without checking the arguments must not be returned
+	// when they are checked
+	ex a = sqrt(ex(2)) * x, b = x;
+	try {
+		gcd(a, b, NULL, NULL, false);
+	} catch (const std::exception &) {
+	}
+	try {
+		gcd(a, b);
+		clog << "cached gcd(" << a << "," << b << ") did not check its arguments" << endl;
+		++result;
+	} catch (const std::invalid_argument &) {
+	}
+	gcd_cache::disable();
+	if (gcd_cache::size() != 0) {
+		clog << "gcd cache not emptied when disabled" << endl;
+		++result;
+	}
+
+	// Cache for the duration of normal()
+	ex e = 1/f + 1/g + x/f - z/g;
+	if (!(e.normal(0, normal_options::cache_gcd) - e.normal()).normal().is_zero()) {
+		clog << "normal() with gcd cache gives " << e.normal(0, normal_options::cache_gcd)
+		     << " instead of " << e.normal() << endl;
+		++result;
+	}
+	if (gcd_cache::is_enabled()) {
+		clog << "gcd cache still enabled after normal()" << endl;
+		++result;
+	}
+	return result;
+}
+
 unsigned exam_polygcd()
 {
 	unsigned result = 0;
@@ -245,6 +336,8 @@ unsigned exam_polygcd()
 	result += poly_gcd5p();  cout << '.' << flush;
 	result += poly_gcd6();  cout << '.' << flush;
 	result += poly_gcd7();  cout << '.' << flush;
+	result += poly_gcd_sparse();  cout << '.' << flush;
+	result += poly_gcd_cache();  cout << '.' << flush;
 	
 	return result;
 }
@@ -386,6 +386,50 @@ static unsigned exam_series14()
 	return result;
 }
 
+// Test truncation of products and relative truncation orders.
+static unsigned exam_series15()
+{
+	unsigned result = 0;
+	ex e, d;
+
+	e = sin(x)*cos(x)*exp(x);
+	d = x + pow(x,2) - pow(x,3)/6 + Order(pow(x,4));
+	result += check_series(e,0,d,4);
+
+	e = pow(sin(x),3)*pow(tan(x),-2);
+	d = x - pow(x,3)*7/6 + Order(pow(x,5));
+	result += check_series(e,0,d,5);
+
+	e = sin(x)/pow(x,3);
+	d = pow(x,-2) - numeric(1,6) + Order(x);
+	ex es = e.series(x==0, 3, series_options::relative_order);
+	if (!(ex_to<pseries>(es).convert_to_poly() - d).expand().is_zero()) {
+		clog << "relative series expansion of " << e << " at 0 erroneously returned "
+		     << es << " (instead of " << d << ")" << endl;
+		++result;
+	}
+
+	e = pow(sin(x),3);
+	d = pow(x,3) - pow(x,5)/2 + Order(pow(x,6));
+	es = e.series(x==0, 3, series_options::relative_order);
+	if (!(ex_to<pseries>(es).convert_to_poly() - d).expand().is_zero()) {
+		clog << "relative series expansion of " << e << " at 0 erroneously returned "
+		     << es << " (instead of " << d << ")" << endl;
+		++result;
+	}
+
+	// Zero, but not recognized as zero: there is no leading term
+	e = pow(sin(x),2) + pow(cos(x),2) - 1;
+	es = e.series(x==0, 3, series_options::relative_order);
+	if (!is_a<pseries>(es) || !ex_to<pseries>(es).convert_to_poly(true).is_zero()) {
+		clog << "relative series expansion of " << e << " at 0 erroneously returned "
+		     << es << " (instead of an order term)" << endl;
+		++result;
+	}
+
+	return result;
+}
+
 unsigned exam_pseries()
 {
 	unsigned result = 0;
@@ -406,6 +450,7 @@ unsigned exam_pseries()
 	result += exam_series12();  cout << '.' << flush;
 	result += exam_series13();  cout << '.' << flush;
 	result += exam_series14();  cout << '.' << flush;
+	result += exam_series15();  cout << '.' << flush;
 	
 	return result;
 }
@@ -23,6 +23,7 @@
 #include "ginac.h"
 using namespace GiNaC;
 
+#include <cstddef>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -96,6 +97,67 @@ static int check4(std::ostream& err_str)
 	}
 }
 
+/// parsing from memory and from a stream must agree, also after the
+/// symbol table has been changed behind the parser's back
+static int check5(std::ostream& err_str)
+{
+	const std::string srep("x_1^2 + 3*x_1*y # comment\n - 123456789*y + 12345678901234567890");
+	parser reader;
+	ex e1 = reader(srep);
+	std::istringstream is(srep);
+	ex e2 = reader(is);
+	if (!(e1 - e2).expand().is_zero()) {
+		err_str << "\"" << srep << "\" parsed as \"" << e1
+			<< "\" from memory, but as \"" << e2
+			<< "\" from a stream" << std::endl;
+		return 1;
+	}
+	symbol z("z");
+	reader.get_syms()["y"] = z;
+	ex e3 = reader(srep);
+	if (!e3.has(z)) {
+		err_str << "parser ignores changes of the symbol table: \""
+			<< e3 << "\"" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+/// sums built in chunks must come out the same as sums built at once
+static int check6(std::ostream& err_str)
+{
+	const std::string srep("a - b + 2*c - x^2*y + 3*b - (a+b) + c/d - 4 - a + 5*b*c - c + b");
+	parser reader;
+	ex e1 = reader(srep);
+	for (std::size_t chunk = 1; chunk < 6; ++chunk) {
+		reader.sum_chunk_size = chunk;
+		ex e2 = reader(srep);
+		if (!(e1 - e2).expand().is_zero()) {
+			err_str << "\"" << srep << "\" was misparsed as \"" << e2
+				<< "\" with chunk size " << chunk << std::endl;
+			return 1;
+		}
+	}
+
+	// Chunks that start right after a '-', and after other operators
+	const char* nreps[] = { "1 - 2 - 4 + 8 - 16 + 32 - 64",
+	                        "1 + 2*3 - 4/2 + 2^3 - (5-6-7) + 8" };
+	const int values[] = { -45, 29 };
+	for (std::size_t i = 0; i < 2; ++i) {
+		for (std::size_t chunk = 1; chunk < 6; ++chunk) {
+			reader.sum_chunk_size = chunk;
+			ex e = reader(nreps[i]);
+			if (!e.is_equal(values[i])) {
+				err_str << "\"" << nreps[i] << "\" was parsed as \"" << e
+					<< "\" instead of " << values[i] << " with chunk size "
+					<< chunk << std::endl;
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
 int main(int argc, char** argv)
 {
 	std::cout << "checking for parser bugs. " << std::flush;
@@ -105,6 +167,8 @@ int main(int argc, char** argv)
 	errors += check2(err_str);
 	errors += check3(err_str);
 	errors += check4(err_str);
+	errors += check5(err_str);
+	errors += check6(err_str);
 	if (errors) {
 		std::cout << "Yes, unfortunately:" << std::endl;
 		std::cout << err_str.str();
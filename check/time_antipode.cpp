@@ -501,6 +501,7 @@ unsigned time_antipode()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -509,3 +510,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_antipode();
 }
+#endif
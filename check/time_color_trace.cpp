@@ -0,0 +1,108 @@
+/** @file time_color_trace.cpp
+ *
+ *  Time SU(N) traces of crossed strings of generators, T_a1..T_an T_a1..T_an,
+ *  as they appear in non-planar diagrams. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ginac.h"
+#include "timer.h"
+using namespace GiNaC;
+
+#include <iostream>
+#include <vector>
+using namespace std;
+
+unsigned color_trace_crossed(unsigned length)
+{
+	unsigned result = 0;
+	const symbol N("N");
+
+	exvector indices;
+	for (unsigned i=0; i<length/2; ++i)
+		indices.push_back(idx(symbol(), 8));
+
+	ex e = color_ONE(), r = color_ONE();
+	for (unsigned i=0; i<length; ++i) {
+		e = e * color_T(indices[i%indices.size()]);
+		r = r * color_T(indices[(length-1-i)%indices.size()]);
+	}
+
+	const ex tr = color_trace(e, 0, N);
+
+	// The trace of a fully contracted string is real, so it is not
+	// changed by reversing the string.
+	if (!is_a<numeric>(tr.subs(N == 3)) || !(tr - color_trace(r, 0, N)).is_zero()) {
+		clog << "trace of " << length << " crossed generators was miscalculated:" << endl
+		     << tr << endl;
+		++result;
+	}
+
+	return result;
+}
+
+unsigned time_color_trace()
+{
+	unsigned result = 0;
+
+	cout << "timing SU(N) traces of crossed strings of generators" << flush;
+
+	vector<unsigned> lengths;
+	vector<double> times;
+	timer rolex;
+
+	lengths.push_back(8);
+	lengths.push_back(10);
+	lengths.push_back(12);
+
+	for (vector<unsigned>::iterator i=lengths.begin(); i!=lengths.end(); ++i) {
+		int count = 1;
+		rolex.start();
+		result += color_trace_crossed(*i);
+		// correct for very small times:
+		while (rolex.read()<0.1) {
+			color_trace_crossed(*i);
+			++count;
+		}
+		times.push_back(rolex.read()/count);
+		cout << '.' << flush;
+	}
+
+	// print the report:
+	cout << endl << "	generators:";
+	for (vector<unsigned>::iterator i=lengths.begin(); i!=lengths.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl << "	time/s:";
+	for (vector<double>::iterator i=times.begin(); i!=times.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl;
+
+	return result;
+}
+
+#ifndef GINAC_BENCH
+extern void randomify_symbol_serials();
+
+int main(int argc, char** argv)
+{
+	randomify_symbol_serials();
+	cout << setprecision(2) << showpoint;
+	return time_color_trace();
+}
+#endif
@@ -94,6 +94,7 @@ unsigned time_dennyfliegner()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -102,3 +103,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_dennyfliegner();
 }
+#endif
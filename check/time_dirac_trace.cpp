@@ -0,0 +1,117 @@
+/** @file time_dirac_trace.cpp
+ *
+ *  Time traces of long strings of slashed momenta, as they appear in loop
+ *  calculations.  Four momenta are repeated cyclically, and all their
+ *  scalar products are given. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ginac.h"
+#include "timer.h"
+using namespace GiNaC;
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+unsigned dirac_trace_slashes(unsigned length)
+{
+	unsigned result = 0;
+	const symbol D("D"), s("s");
+	const symbol p[4] = { symbol("p1"), symbol("p2"), symbol("p3"), symbol("p4") };
+
+	scalar_products sp;
+	exmap all_equal;
+	for (unsigned i=0; i<4; ++i)
+		for (unsigned j=i; j<4; ++j) {
+			ostringstream name;
+			name << 's' << i+1 << j+1;
+			const symbol sij(name.str());
+			sp.add(p[i], p[j], sij);
+			all_equal[sij] = s;
+		}
+
+	ex e = dirac_ONE();
+	for (unsigned i=0; i<length; ++i)
+		e = e * dirac_slash(p[i%4], D);
+
+	const ex tr = dirac_trace(e, 0, sp);
+
+	// If all scalar products are equal, so are the momenta, and
+	// Tr p^n = 4 (p.p)^(n/2).
+	if (!(tr.subs(all_equal).expand() - 4*pow(s, length/2)).is_zero()) {
+		clog << "trace of " << length << " slashed momenta was miscalculated:" << endl
+		     << tr << endl;
+		++result;
+	}
+
+	return result;
+}
+
+unsigned time_dirac_trace()
+{
+	unsigned result = 0;
+
+	cout << "timing traces of strings of slashed momenta" << flush;
+
+	vector<unsigned> lengths;
+	vector<double> times;
+	timer seiko;
+
+	lengths.push_back(8);
+	lengths.push_back(10);
+	lengths.push_back(12);
+	lengths.push_back(14);
+
+	for (vector<unsigned>::iterator i=lengths.begin(); i!=lengths.end(); ++i) {
+		int count = 1;
+		seiko.start();
+		result += dirac_trace_slashes(*i);
+		// correct for very small times:
+		while (seiko.read()<0.1) {
+			dirac_trace_slashes(*i);
+			++count;
+		}
+		times.push_back(seiko.read()/count);
+		cout << '.' << flush;
+	}
+
+	// print the report:
+	cout << endl << "	gammas:";
+	for (vector<unsigned>::iterator i=lengths.begin(); i!=lengths.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl << "	time/s:";
+	for (vector<double>::iterator i=times.begin(); i!=times.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl;
+
+	return result;
+}
+
+#ifndef GINAC_BENCH
+extern void randomify_symbol_serials();
+
+int main(int argc, char** argv)
+{
+	randomify_symbol_serials();
+	cout << setprecision(2) << showpoint;
+	return time_dirac_trace();
+}
+#endif
@@ -83,6 +83,7 @@ unsigned time_gammaseries()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -91,3 +92,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_gammaseries();
 }
+#endif
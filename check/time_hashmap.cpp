@@ -107,6 +107,7 @@ unsigned time_hashmap()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -115,3 +116,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_hashmap();
 }
+#endif
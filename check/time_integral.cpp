@@ -0,0 +1,95 @@
+/** @file time_integral.cpp
+ *
+ *  Time the numeric evaluation of integrals, with a different upper bound
+ *  each time so that the lookup table of computed integrals does not help. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ginac.h"
+#include "timer.h"
+using namespace GiNaC;
+
+#include <iostream>
+#include <vector>
+using namespace std;
+
+unsigned integral_evalf(unsigned count)
+{
+	unsigned result = 0;
+	const symbol x("x");
+	const ex f = 1/(1+pow(x,2)) + x*exp(x) + sqrt(1+x);
+
+	for (unsigned n=1; n<=count; ++n) {
+		const numeric b(n, count);
+		const ex value = integral(x, 0, b, f).evalf();
+		const ex exact = (atan(b) + (b-1)*exp(b) + 1 + numeric(2,3)*(pow(1+b,numeric(3,2))-1)).evalf();
+		if (!is_a<numeric>(value) || abs(ex_to<numeric>(value/exact-1)) > 1e-7) {
+			clog << "integral(x, 0, " << b << ", " << f << ") was miscomputed: "
+			     << value << " instead of " << exact << endl;
+			++result;
+		}
+	}
+
+	return result;
+}
+
+unsigned time_integral()
+{
+	unsigned result = 0;
+
+	cout << "timing numeric evaluation of integrals" << flush;
+
+	vector<unsigned> counts;
+	vector<double> times;
+	timer omega;
+
+	counts.push_back(10);
+	counts.push_back(20);
+	counts.push_back(40);
+	counts.push_back(80);
+
+	for (vector<unsigned>::iterator i=counts.begin(); i!=counts.end(); ++i) {
+		omega.start();
+		result += integral_evalf(*i);
+		times.push_back(omega.read());
+		cout << '.' << flush;
+	}
+
+	// print the report:
+	cout << endl << "	integrals:";
+	for (vector<unsigned>::iterator i=counts.begin(); i!=counts.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl << "	time/s:";
+	for (vector<double>::iterator i=times.begin(); i!=times.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl;
+
+	return result;
+}
+
+#ifndef GINAC_BENCH
+extern void randomify_symbol_serials();
+
+int main(int argc, char** argv)
+{
+	randomify_symbol_serials();
+	cout << setprecision(2) << showpoint;
+	return time_integral();
+}
+#endif
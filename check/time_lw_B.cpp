@@ -63,6 +63,7 @@ unsigned time_lw_B()
 	
 	return result;
 }
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -71,3 +72,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_lw_B();
 }
+#endif
@@ -68,6 +68,7 @@ unsigned time_lw_D()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -76,3 +77,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_lw_D();
 }
+#endif
@@ -87,6 +87,7 @@ unsigned time_lw_IJKL()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -95,3 +96,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_lw_IJKL();
 }
+#endif
@@ -91,6 +91,7 @@ unsigned time_lw_Pprime()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -99,3 +100,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_lw_Pprime();
 }
+#endif
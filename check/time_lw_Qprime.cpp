@@ -97,6 +97,7 @@ unsigned time_lw_Qprime()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -105,3 +106,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_lw_Qprime();
 }
+#endif
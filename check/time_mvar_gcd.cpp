@@ -0,0 +1,102 @@
+/** @file time_mvar_gcd.cpp
+ *
+ *  Time the GCD of two trivariate polynomials with a large common factor,
+ *  gcd((1+x+y+z)^d*(2+x-y+z)^d, (1+x+y+z)^d*(3-x+y*z)^d), for growing d. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ginac.h"
+#include "timer.h"
+using namespace GiNaC;
+
+#include <iostream>
+#include <vector>
+using namespace std;
+
+unsigned mvar_gcd(unsigned degree)
+{
+	unsigned result = 0;
+	const symbol x("x"), y("y"), z("z");
+
+	const ex g = expand(pow(1+x+y+z, degree));
+	const ex a = expand(g * pow(2+x-y+z, degree));
+	const ex b = expand(g * pow(3-x+y*z, degree));
+
+	const ex d = gcd(a, b);
+
+	if (!(d - g).is_zero() && !(d + g).is_zero()) {
+		clog << "gcd of (1+x+y+z)^" << degree << "*(2+x-y+z)^" << degree
+		     << " and (1+x+y+z)^" << degree << "*(3-x+y*z)^" << degree
+		     << " was miscomputed:" << endl << d << endl;
+		++result;
+	}
+
+	return result;
+}
+
+unsigned time_mvar_gcd()
+{
+	unsigned result = 0;
+
+	cout << "timing GCD of trivariate polynomials" << flush;
+
+	vector<unsigned> degrees;
+	vector<double> times;
+	timer breitling;
+
+	degrees.push_back(2);
+	degrees.push_back(4);
+	degrees.push_back(6);
+	degrees.push_back(8);
+
+	for (vector<unsigned>::iterator i=degrees.begin(); i!=degrees.end(); ++i) {
+		int count = 1;
+		breitling.start();
+		result += mvar_gcd(*i);
+		// correct for very small times:
+		while (breitling.read()<0.1) {
+			mvar_gcd(*i);
+			++count;
+		}
+		times.push_back(breitling.read()/count);
+		cout << '.' << flush;
+	}
+
+	// print the report:
+	cout << endl << "	degree:";
+	for (vector<unsigned>::iterator i=degrees.begin(); i!=degrees.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl << "	time/s:";
+	for (vector<double>::iterator i=times.begin(); i!=times.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl;
+
+	return result;
+}
+
+#ifndef GINAC_BENCH
+extern void randomify_symbol_serials();
+
+int main(int argc, char** argv)
+{
+	randomify_symbol_serials();
+	cout << setprecision(2) << showpoint;
+	return time_mvar_gcd();
+}
+#endif
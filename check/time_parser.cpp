@@ -25,7 +25,9 @@
 using namespace GiNaC;
 
 #include <cstddef>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -33,7 +35,9 @@ using namespace GiNaC;
 #include <vector>
 using namespace std;
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
+#endif
 
 /// make a string "1+x+2*x^2+...+n*x^n"
 static string prepare_str(const unsigned n, const char x = 'x')
@@ -55,14 +59,90 @@ static double benchmark_and_cmp(const string& srep)
 	return t;
 }
 
-int main(int argc, char** argv)
+/// write about mbytes MB of a sum of monomials in 26 symbols
+static unsigned long write_big_sum(ostream& os, const unsigned mbytes)
+{
+	const unsigned long target = static_cast<unsigned long>(mbytes) << 20;
+	unsigned long written = 0;
+	unsigned long terms = 0;
+	unsigned seed = 1;
+	while (written < target) {
+		ostringstream t;
+		seed = seed*1103515245 + 12345;
+		t << (terms ? "+" : "") << (seed >> 16) % 1000;
+		for (unsigned j = 0; j < 3; ++j) {
+			seed = seed*1103515245 + 12345;
+			t << '*' << char('a' + (seed >> 16) % 26) << '^' << 1 + (seed >> 8) % 5;
+		}
+		const string ts = t.str();
+		os << ts;
+		written += ts.size();
+		++terms;
+	}
+	return terms;
+}
+
+/// write a file of about mbytes MB with a sum of monomials in 26 symbols
+static unsigned long write_big_file(const string& filename, const unsigned mbytes)
+{
+	ofstream os(filename.c_str());
+	return write_big_sum(os, mbytes);
+}
+
+/// parse a sum of about mbytes MB from memory, the sum is kept for the next call
+unsigned parse_big_sum(const unsigned mbytes)
+{
+	static unsigned cached_mbytes = 0;
+	static string srep;
+	if (mbytes != cached_mbytes) {
+		ostringstream os;
+		write_big_sum(os, mbytes);
+		srep = os.str();
+		cached_mbytes = mbytes;
+	}
+
+	parser the_parser;
+	const ex e = the_parser(srep);
+	if (!is_a<add>(e)) {
+		clog << "parsing a sum of " << mbytes << " MB gave " << e << endl;
+		return 1;
+	}
+	return 0;
+}
+
+/// time parsing a file from a stream and from memory
+static void benchmark_file(const unsigned mbytes)
+{
+	const string filename = "time_parser.tmp";
+	const unsigned long terms = write_big_file(filename, mbytes);
+
+	timer RSD10;
+	parser stream_parser;
+	ifstream is(filename.c_str());
+	RSD10.start();
+	ex e1 = stream_parser(is);
+	const double t_stream = RSD10.read();
+	is.close();
+
+	parser file_parser;
+	RSD10.start();
+	ex e2 = file_parser.parse_file(filename);
+	const double t_file = RSD10.read();
+	remove(filename.c_str());
+
+	if (e1.nops() != e2.nops())
+		throw runtime_error("parse_file() and stream parser disagree");
+
+	cout << "# " << mbytes << " MB, " << terms << " terms" << endl;
+	cout << " stream\t" << t_stream << endl;
+	cout << " file\t" << t_file << endl;
+}
+
+/// time parsing sums of up to n_max terms and a file of mbytes MB
+unsigned time_parser(const unsigned n_max, const unsigned mbytes)
 {
 	cout << "timing GiNaC parser..." << flush;
-	randomify_symbol_serials();
 	unsigned n_min = 1024;
-	unsigned n_max = 32768;
-	if (argc > 1)
-		n_max = atoi(argv[1]);
 
 	vector<double> times;
 	vector<unsigned> ns;
@@ -77,5 +157,20 @@ int main(int argc, char** argv)
 	cout << "# terms  time, s" << endl;
 	for (size_t i = 0; i < times.size(); i++)
 		cout << " " << ns[i] << '\t' << times[i] << endl;
+	benchmark_file(mbytes);
 	return 0;
 }
+
+#ifndef GINAC_BENCH
+int main(int argc, char** argv)
+{
+	randomify_symbol_serials();
+	unsigned n_max = 32768;
+	unsigned mbytes = 4;
+	if (argc > 1)
+		n_max = atoi(argv[1]);
+	if (argc > 2)
+		mbytes = atoi(argv[2]);
+	return time_parser(n_max, mbytes);
+}
+#endif
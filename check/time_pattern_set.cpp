@@ -0,0 +1,161 @@
+/** @file time_pattern_set.cpp
+ *
+ *  Time looking for many patterns at once in a sum of 400 products of powers
+ *  of sines and cosines, sum(sin(s_j)^(k+2)*cos(s_k), j,k=0..19), with the
+ *  patterns sin($0)^(i+2)*cos($1), i=0..n-1, for growing n. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ginac.h"
+#include "timer.h"
+using namespace GiNaC;
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+unsigned pattern_set_find(unsigned count)
+{
+	unsigned result = 0;
+	const unsigned n = 20;
+
+	exvector s;
+	for (unsigned i=0; i<n; ++i)
+		s.push_back(symbol());
+
+	exvector terms;
+	for (unsigned j=0; j<n; ++j)
+		for (unsigned k=0; k<n; ++k)
+			terms.push_back(pow(sin(s[j]), k+2)*cos(s[k]));
+	const ex e = add(terms);
+
+	pattern_set rules;
+	for (unsigned i=0; i<count; ++i)
+		rules.add(pow(sin(wild(0)), i+2)*cos(wild(1)));
+
+	exset found;
+	e.find(rules, found);
+	if (found.size() != n*min(count, n)) {
+		clog << "found " << found.size() << " instead of " << n*min(count, n)
+		     << " occurrences of " << count << " patterns" << endl;
+		++result;
+	}
+	if (!e.has(rules)) {
+		clog << "none of " << count << " patterns was found" << endl;
+		++result;
+	}
+
+	return result;
+}
+
+/** The same patterns as keys of a substitution map.  subs() keeps the keys
+ *  in a pattern_set, so this can be compared with earlier versions. */
+unsigned pattern_set_subs(unsigned count)
+{
+	unsigned result = 0;
+	const unsigned n = 20;
+
+	exvector s;
+	for (unsigned i=0; i<n; ++i)
+		s.push_back(symbol());
+
+	exvector terms;
+	for (unsigned j=0; j<n; ++j)
+		for (unsigned k=0; k<n; ++k)
+			terms.push_back(pow(sin(s[j]), k+2)*cos(s[k]));
+	const ex e = add(terms);
+
+	exmap rules;
+	for (unsigned i=0; i<count; ++i)
+		rules[pow(sin(wild(0)), i+2)*cos(wild(1))] = 0;
+
+	const ex r = e.subs(rules);
+	const size_t left = is_a<add>(r) ? r.nops() : (r.is_zero() ? 0 : 1);
+	if (left != n*(n-min(count, n))) {
+		clog << "substituting " << count << " patterns left " << left
+		     << " terms instead of " << n*(n-min(count, n)) << endl;
+		++result;
+	}
+
+	return result;
+}
+
+unsigned time_pattern_set()
+{
+	unsigned result = 0;
+
+	cout << "timing search for many patterns at once" << flush;
+
+	vector<unsigned> counts;
+	vector<double> times, subs_times;
+	timer rolex;
+
+	counts.push_back(10);
+	counts.push_back(20);
+	counts.push_back(40);
+	counts.push_back(80);
+
+	for (vector<unsigned>::iterator i=counts.begin(); i!=counts.end(); ++i) {
+		int count = 1;
+		rolex.start();
+		result += pattern_set_find(*i);
+		// correct for very small times:
+		while (rolex.read()<0.1) {
+			pattern_set_find(*i);
+			++count;
+		}
+		times.push_back(rolex.read()/count);
+
+		count = 1;
+		rolex.start();
+		result += pattern_set_subs(*i);
+		while (rolex.read()<0.1) {
+			pattern_set_subs(*i);
+			++count;
+		}
+		subs_times.push_back(rolex.read()/count);
+		cout << '.' << flush;
+	}
+
+	// print the report:
+	cout << endl << "	patterns:";
+	for (vector<unsigned>::iterator i=counts.begin(); i!=counts.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl << "	time/s:";
+	for (vector<double>::iterator i=times.begin(); i!=times.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl << "	subs/s:";
+	for (vector<double>::iterator i=subs_times.begin(); i!=subs_times.end(); ++i)
+		cout << '\t' << *i;
+	cout << endl;
+
+	return result;
+}
+
+#ifndef GINAC_BENCH
+extern void randomify_symbol_serials();
+
+int main(int argc, char** argv)
+{
+	randomify_symbol_serials();
+	cout << setprecision(2) << showpoint;
+	return time_pattern_set();
+}
+#endif
@@ -1881,7 +1881,7 @@ run_with_random_intputs(const unsigned d1, const unsigned d2)
 	run_benchmark(b_sr);
 }
 
-int main(int argc, char** argv)
+unsigned time_uvar_gcd()
 {
 	std::cout << "timing univarite GCD" << std::endl << std::flush;
 	run_with_random_intputs(100, 50);
@@ -1897,6 +1897,13 @@ int main(int argc, char** argv)
 	return 0;
 }
 
+#ifndef GINAC_BENCH
+int main(int argc, char** argv)
+{
+	return time_uvar_gcd();
+}
+#endif
+
 static upoly make_random_upoly(const std::size_t deg)
 {
 	static const cln::cl_I biggish("987654321098765432109876543210");
@@ -32,7 +32,7 @@ using namespace GiNaC;
 #include <vector>
 using namespace std;
 
-static unsigned vandermonde_det(unsigned size)
+unsigned vandermonde_det(unsigned size)
 {
 	unsigned result = 0;
 	const symbol a("a");
@@ -107,6 +107,7 @@ unsigned time_vandermonde()
 	return result;
 }
 
+#ifndef GINAC_BENCH
 extern void randomify_symbol_serials();
 
 int main(int argc, char** argv)
@@ -115,3 +116,4 @@ int main(int argc, char** argv)
 	cout << setprecision(2) << showpoint;
 	return time_vandermonde();
 }
+#endif
@@ -32,13 +32,17 @@
 #include "operators.h"
 #include "wildcard.h"
 #include "archive.h"
+#include "compiler.h"
 #include "utils.h"
 #include "hash_seed.h"
 #include "inifcns.h"
+#include "pattern_set.h"
 
 #include <iostream>
+#include <map>
 #include <stdexcept>
 #include <typeinfo>
+#include <vector>
 
 namespace GiNaC {
 
@@ -58,6 +62,7 @@ GINAC_IMPLEMENT_REGISTERED_CLASS_OPT(basic, void,
  *  tinfo_key and the hash value. */
 basic::basic(const basic & other) : flags(other.flags & ~status_flags::dynallocated), hashvalue(other.hashvalue)
 {
+	++profiler::objects_created;
 }
 
 /** basic assignment operator: the other object might be of a derived class. */
@@ -590,6 +595,115 @@ bool basic::match(const ex & pattern, exmap& repl_lst) const
 	}
 }
 
+namespace {
+
+/** Book-keeping for one substitution run, i.e. for all ex::subs() calls
+ *  with the same substitution map and options below one top-level call.
+ *
+ *  Subexpressions that are referenced more than once can be reached along
+ *  several paths through the expression DAG.  Their substitution results are
+ *  remembered, so every such subexpression is processed only once instead of
+ *  once per path.  Objects referenced only once cannot be reached twice and
+ *  are not recorded.  References held by temporary copies of the operands,
+ *  like the ones op() returns, are not counted (see subs_with_memo()).
+ *
+ *  The innermost run is kept per thread, so substitutions in different
+ *  threads do not see each other's runs.
+ *
+ *  For substitutions with pattern matching, the keys of the substitution map
+ *  are collected in a pattern_set on demand, so that subs_one_level() only
+ *  tries to match() those keys that can possibly match an object. */
+class subs_run {
+public:
+	subs_run(const exmap & m_, unsigned options_) : m(m_), options(options_), outer(active), keys_indexed(false)
+	{
+		active = this;
+	}
+	~subs_run() { active = outer; }
+
+	bool is_run_of(const exmap & m_, unsigned options_) const
+	{
+		return &m == &m_ && options == options_;
+	}
+
+	ex subs(const ex & e, unsigned temporary_refs);
+	bool match(const basic & e, exmap & repl_lst, exmap::const_iterator & which);
+
+	/** Innermost active substitution run of this thread (0 if none). */
+	static GINAC_THREAD_LOCAL subs_run * active;
+
+private:
+	const exmap & m;
+	unsigned options;
+	subs_run * outer;
+
+	/** Substitution results of shared subexpressions.  The original object
+	 *  is held as well, so its address cannot be reused while the run is
+	 *  active. */
+	std::map<const basic *, std::pair<ex, ex> > results;
+
+	/** The keys of the substitution map, in the order of the map. */
+	bool keys_indexed;
+	pattern_set keys;
+	std::vector<exmap::const_iterator> rules;
+};
+
+GINAC_THREAD_LOCAL subs_run * subs_run::active = 0;
+
+ex subs_run::subs(const ex & e, unsigned temporary_refs)
+{
+	const basic & b = ex_to<basic>(e);
+	if (b.get_refcount() <= 1 + temporary_refs || b.nops() == 0)
+		return b.subs(m, options);
+
+	std::map<const basic *, std::pair<ex, ex> >::const_iterator found = results.find(&b);
+	if (found != results.end())
+		return found->second.second;
+
+	ex result = b.subs(m, options);
+	results.insert(std::make_pair(&b, std::make_pair(e, result)));
+	return result;
+}
+
+/** Match an object against the keys of the substitution map.  If one of
+ *  them matches, the first one is returned in "which". */
+bool subs_run::match(const basic & e, exmap & repl_lst, exmap::const_iterator & which)
+{
+	if (!keys_indexed) {
+		rules.reserve(m.size());
+		for (exmap::const_iterator it = m.begin(); it != m.end(); ++it) {
+			keys.add(it->first);
+			rules.push_back(it);
+		}
+		keys_indexed = true;
+	}
+
+	size_t i;
+	if (!keys.match(e, repl_lst, i))
+		return false;
+	which = rules[i];
+	return true;
+}
+
+} // anonymous namespace
+
+/** Substitute in an expression within the current substitution run, or
+ *  start a new run if the map or options are not the ones of the current
+ *  run.  This is what ex::subs() does.
+ *
+ *  @param temporary_refs number of references to the object of e held by
+ *    temporary copies of the caller, for instance 1 if e was returned by
+ *    op(); they are not counted when deciding whether e is shared
+ *  @see subs_run */
+ex subs_with_memo(const ex & e, const exmap & m, unsigned options, unsigned temporary_refs)
+{
+	if (subs_run::active && subs_run::active->is_run_of(m, options))
+		return subs_run::active->subs(e, temporary_refs);
+
+	subs_run run(m, options);
+	return ex_to<basic>(e).subs(m, options);
+}
+
 /** Helper function for subs(). Does not recurse into subexpressions. */
 ex basic::subs_one_level(const exmap & m, unsigned options) const
 {
@@ -601,6 +715,12 @@ ex basic::subs_one_level(const exmap & m, unsigned options) const
 		if (it != m.end())
 			return it->second;
 		return thisex;
+	} else if (subs_run::active && subs_run::active->is_run_of(m, options)) {
+		// Only try the keys that can match at all
+		exmap repl_lst;
+		if (subs_run::active->match(*this, repl_lst, it))
+			return it->second.subs(repl_lst, options | subs_options::no_pattern);
+			// avoid infinite recursion when re-substituting the wildcards
 	} else {
 		for (it = m.begin(); it != m.end(); ++it) {
 			exmap repl_lst;
@@ -621,9 +741,11 @@ ex basic::subs(const exmap & m, unsigned options) const
 	if (num) {
 
 		// Substitute in subexpressions
+		// (op() returns a copy of the operand, which holds one more
+		// reference to it)
 		for (size_t i=0; i<num; i++) {
 			const ex & orig_op = op(i);
-			const ex & subsed_op = orig_op.subs(m, options);
+			const ex & subsed_op = subs_with_memo(orig_op, m, options, 1);
 			if (!are_ex_trivially_equal(orig_op, subsed_op)) {
 
 				// Something changed, clone the object
@@ -636,7 +758,7 @@ ex basic::subs(const exmap & m, unsigned options) const
 
 				// Substitute the other operands
 				for (; i<num; i++)
-					copy->let_op(i) = op(i).subs(m, options);
+					copy->let_op(i) = subs_with_memo(op(i), m, options, 1);
 
 				// Perform substitutions on the new object as a whole
 				return copy->subs_one_level(m, options);
@@ -827,6 +949,7 @@ ex basic::expand(unsigned options) const
  *  1 greater. */
 int basic::compare(const basic & other) const
 {
+	profiler::count(profiled_ops::compare);
 #ifdef GINAC_COMPARE_STATISTICS
 	compare_statistics.total_basic_compares++;
 #endif
@@ -27,6 +27,7 @@
 #include "ptr.h"
 #include "assertion.h"
 #include "registrar.h"
+#include "profiler.h"
 
 // CINT needs <algorithm> to work properly with <vector>
 #include <algorithm>
@@ -109,7 +110,7 @@ class basic : public refcounted
 	
 	// default constructor, destructor, copy constructor and assignment operator
 protected:
-	basic() : flags(0) {}
+	basic() : flags(0) { ++profiler::objects_created; }
 
 public:
 	/** basic destructor, virtual because class ex will delete objects of
@@ -195,7 +196,7 @@ public:
 	virtual ex series(const relational & r, int order, unsigned options = 0) const;
 
 	// rational functions
-	virtual ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const;
+	virtual ex normal(exmap & repl, exmap & rev_lookup, int level = 0, unsigned options = 0) const;
 	virtual ex to_rational(exmap & repl) const;
 	virtual ex to_polynomial(exmap & repl) const;
 
@@ -0,0 +1,105 @@
+/** @file cancellation.cpp
+ *
+ *  Implementation of the cooperative cancellation of long computations. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cancellation.h"
+
+#include <ctime>
+
+namespace GiNaC {
+
+computation_cancelled::computation_cancelled(const std::string& what_arg, const char* site,
+                                             unsigned long polls, double seconds)
+	: msg(what_arg), site_(site), polls_(polls), seconds_(seconds) { }
+
+volatile std::sig_atomic_t cancellation::armed = 0;
+volatile std::sig_atomic_t cancellation::requested = 0;
+
+namespace {
+
+/** Asking for the time is much more expensive than a poll, so it is only
+ *  done every so many polls. */
+const unsigned long clock_interval = 16;
+
+struct cancellation_state {
+	cancellation_state() : has_deadline(false), start(0), deadline(0), polls(0) {}
+
+	bool has_deadline;
+	std::clock_t start;
+	std::clock_t deadline;
+	unsigned long polls;
+};
+
+cancellation_state & state()
+{
+	static cancellation_state s;
+	return s;
+}
+
+} // anonymous namespace
+
+void cancellation::set_timeout(double seconds)
+{
+	cancellation_state & s = state();
+	s.start = std::clock();
+	s.deadline = s.start + static_cast<std::clock_t>(seconds * CLOCKS_PER_SEC);
+	s.has_deadline = true;
+	s.polls = 0;
+	requested = 0;
+	armed = 1;
+}
+
+void cancellation::request()
+{
+	requested = 1;
+	armed = 1;
+}
+
+void cancellation::reset()
+{
+	armed = 0;
+	requested = 0;
+	cancellation_state & s = state();
+	s.has_deadline = false;
+	s.polls = 0;
+}
+
+unsigned long cancellation::polls()
+{
+	return state().polls;
+}
+
+void cancellation::check(const char* site)
+{
+	cancellation_state & s = state();
+	++s.polls;
+	if (!requested && s.has_deadline && s.polls % clock_interval == 1 &&
+	    std::clock() >= s.deadline)
+		requested = 1;
+	if (!requested)
+		return;
+
+	const double seconds = s.has_deadline ? double(std::clock() - s.start) / CLOCKS_PER_SEC : 0;
+	throw computation_cancelled(std::string("computation cancelled in ") + site,
+	                            site, s.polls, seconds);
+}
+
+} // namespace GiNaC
@@ -0,0 +1,103 @@
+/** @file cancellation.h
+ *
+ *  Interface to the cooperative cancellation of long computations. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_CANCELLATION_H
+#define GINAC_CANCELLATION_H
+
+#include <csignal>
+#include <exception>
+#include <string>
+
+namespace GiNaC {
+
+/** Exception thrown by a computation that was cancelled, either because
+ *  its time budget ran out or because cancellation::request() was called.
+ *  It tells which algorithm noticed the cancellation and how far the
+ *  computation had come.  It is not derived from std::runtime_error, so
+ *  that code catching the errors of an algorithm does not swallow it. */
+class computation_cancelled : public std::exception {
+public:
+	computation_cancelled(const std::string& what_arg, const char* site,
+	                      unsigned long polls, double seconds);
+	~computation_cancelled() throw() { }
+
+	const char* what() const throw() { return msg.c_str(); }
+
+	/** Name of the algorithm that was interrupted, like "factor". */
+	const char* site() const { return site_; }
+	/** Number of times the algorithms checked for cancellation. */
+	unsigned long polls() const { return polls_; }
+	/** Processor time in seconds since the budget was set. */
+	double seconds() const { return seconds_; }
+private:
+	std::string msg;
+	const char* site_;
+	unsigned long polls_;
+	double seconds_;
+};
+
+/** Cooperative cancellation of long-running algorithms.  The expensive
+ *  algorithms (factor(), gcd(), normal(), expand(), matrix::determinant()
+ *  and series()) call poll() in their inner loops.  While a time budget is
+ *  set or after request() was called, poll() throws computation_cancelled,
+ *  which leaves all expressions and caches intact.  Once triggered, every
+ *  further poll() throws as well, until reset() or set_timeout() is called.
+ *
+ *  The budget is measured in processor time, so that it bounds the work
+ *  done and not the time spent waiting.  request() may be called from a
+ *  signal handler. */
+class cancellation {
+public:
+	/** Cancel computations running longer than the given number of
+	 *  seconds from now.  Any earlier request is forgotten. */
+	static void set_timeout(double seconds);
+
+	/** Cancel the running computation at its next poll(). */
+	static void request();
+
+	/** Forget the time budget and any request. */
+	static void reset();
+
+	/** Whether a time budget is set or cancellation was requested. */
+	static bool is_armed() { return armed != 0; }
+
+	/** Number of polls since the last set_timeout(), request() or reset(). */
+	static unsigned long polls();
+
+	/** Check for cancellation.
+	 *  @param site name of the calling algorithm
+	 *  @exception computation_cancelled */
+	static void poll(const char* site)
+	{
+		if (armed)
+			check(site);
+	}
+
+private:
+	static void check(const char* site);
+	static volatile std::sig_atomic_t armed;
+	static volatile std::sig_atomic_t requested;
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_CANCELLATION_H
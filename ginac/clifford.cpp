@@ -38,6 +38,7 @@
 #include "archive.h"
 #include "utils.h"
 
+#include <map>
 #include <stdexcept>
 
 namespace GiNaC {
@@ -816,43 +817,87 @@ static unsigned char get_representation_label(const return_type_t& ti)
 	return (unsigned char)ti.rl;
 }
 
-/** Take trace of a string of an even number of Dirac gammas given a vector
- *  of indices. */
-static ex trace_string(exvector::const_iterator ix, size_t num)
+namespace {
+
+/** Traces of the substrings of a string of Dirac gammas.  The trace of an
+ *  even number of gammas is computed by pairing the first one with each of
+ *  the others:
+ *    Tr gamma.mu1 gamma.mu2 ... gamma.mun =
+ *      + g.mu1.mu2 * Tr gamma.mu3 ... gamma.mun
+ *      - g.mu1.mu3 * Tr gamma.mu2 gamma.mu4 ... gamma.mun
+ *      + g.mu1.mu4 * Tr gamma.mu2 gamma.mu3 gamma.mu5 ... gamma.mun
+ *      - ...
+ *      + g.mu1.mun * Tr gamma.mu2 ... gamma.mu(n-1)
+ *  Substrings are given by bit masks of the positions they keep.  Many
+ *  paths of this expansion end at the same substring, so the trace of each
+ *  one is remembered and computed only once.  The metric tensors are
+ *  multiplied with the bases of the gammas (the vectors of slashes) and
+ *  contracted beforehand, and the traces are kept expanded, so that traces
+ *  of slashes collapse into polynomials in the scalar products early. */
+class trace_engine {
+public:
+	trace_engine(const exvector & iv, const exvector & bv, const scalar_products & sp);
+
+	/** Trace of the gammas at the positions set in the bit mask. */
+	ex trace(unsigned long positions);
+
+	/** Bit mask of all positions. */
+	unsigned long all() const { return num == max_gammas ? ~0UL : (1UL << num) - 1; }
+
+	static const size_t max_gammas = 8 * sizeof(unsigned long);
+
+private:
+	size_t num;
+	exvector pairs;  ///< contracted g.mua.mub * base_a * base_b, at a*num+b for a<b
+	std::map<unsigned long, ex> memo;
+};
+
+trace_engine::trace_engine(const exvector & iv, const exvector & bv, const scalar_products & sp)
+  : num(iv.size()), pairs(iv.size() * iv.size())
 {
-	// Tr gamma.mu gamma.nu = 4 g.mu.nu
-	if (num == 2)
-		return lorentz_g(ix[0], ix[1]);
-
-	// Tr gamma.mu gamma.nu gamma.rho gamma.sig = 4 (g.mu.nu g.rho.sig + g.nu.rho g.mu.sig - g.mu.rho g.nu.sig )
-	else if (num == 4)
-		return lorentz_g(ix[0], ix[1]) * lorentz_g(ix[2], ix[3])
-		     + lorentz_g(ix[1], ix[2]) * lorentz_g(ix[0], ix[3])
-		     - lorentz_g(ix[0], ix[2]) * lorentz_g(ix[1], ix[3]);
-
-	// Traces of 6 or more gammas are computed recursively:
-	// Tr gamma.mu1 gamma.mu2 ... gamma.mun =
-	//   + g.mu1.mu2 * Tr gamma.mu3 ... gamma.mun
-	//   - g.mu1.mu3 * Tr gamma.mu2 gamma.mu4 ... gamma.mun
-	//   + g.mu1.mu4 * Tr gamma.mu3 gamma.mu3 gamma.mu5 ... gamma.mun
-	//   - ...
-	//   + g.mu1.mun * Tr gamma.mu2 ... gamma.mu(n-1)
-	exvector v(num - 2);
-	int sign = 1;
-	ex result;
-	for (size_t i=1; i<num; i++) {
-		for (size_t n=1, j=0; n<num; n++) {
-			if (n == i)
-				continue;
-			v[j++] = ix[n];
+	if (num > max_gammas)
+		throw std::length_error("dirac_trace(): too many gammas in string");
+
+	for (size_t a=0; a<num; a++)
+		for (size_t b=a+1; b<num; b++)
+			pairs[a * num + b] = (lorentz_g(iv[a], iv[b]) * bv[a] * bv[b]).simplify_indexed(sp);
+}
+
+ex trace_engine::trace(unsigned long positions)
+{
+	if (positions == 0)
+		return _ex1;
+
+	std::map<unsigned long, ex>::const_iterator found = memo.find(positions);
+	if (found != memo.end())
+		return found->second;
+
+	size_t first = 0;
+	while ((positions & (1UL << first)) == 0)
+		first++;
+	const unsigned long rest = positions & ~(1UL << first);
+
+	// The recursion is at most num/2 deep
+	exvector terms;
+	bool negative = false;
+	for (size_t i=first+1; i<num; i++) {
+		if ((rest & (1UL << i)) == 0)
+			continue;
+		const ex & g = pairs[first * num + i];
+		if (!g.is_zero()) {
+			const ex t = g * trace(rest & ~(1UL << i));
+			terms.push_back(negative ? -t : t);
 		}
-		result += sign * lorentz_g(ix[0], ix[i]) * trace_string(v.begin(), num-2);
-		sign = -sign;
+		negative = !negative;
 	}
-	return result;
+
+	const ex result = (new add(terms))->setflag(status_flags::dynallocated);
+	return memo[positions] = result.expand();
 }
 
-ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trONE)
+} // anonymous namespace
+
+ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const scalar_products & sp, const ex & trONE)
 {
 	if (is_a<clifford>(e)) {
 
@@ -878,7 +923,7 @@ ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trO
 		for (size_t i=0; i<e.nops(); i++) {
 			const ex &o = e.op(i);
 			if (is_clifford_tinfo(o.return_type_tinfo()))
-				prod *= dirac_trace(o, rls, trONE);
+				prod *= dirac_trace(o, rls, sp, trONE);
 			else
 				prod *= o;
 		}
@@ -898,7 +943,7 @@ ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trO
 			dirac_gammaR(rl) == (dirac_ONE(rl)+dirac_gamma5(rl))/2
 		), subs_options::no_pattern).expand();
 		if (!is_a<ncmul>(e_expanded))
-			return dirac_trace(e_expanded, rls, trONE);
+			return dirac_trace(e_expanded, rls, sp, trONE);
 
 		// gamma5 gets moved to the front so this check is enough
 		bool has_gamma5 = is_a<diracgamma5>(e.op(0).op(0));
@@ -919,7 +964,7 @@ ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trO
 				base_and_index(e.op(2), b2, i2);
 				base_and_index(e.op(3), b3, i3);
 				base_and_index(e.op(4), b4, i4);
-				return trONE * I * (lorentz_eps(ex_to<idx>(i1).replace_dim(_ex4), ex_to<idx>(i2).replace_dim(_ex4), ex_to<idx>(i3).replace_dim(_ex4), ex_to<idx>(i4).replace_dim(_ex4)) * b1 * b2 * b3 * b4).simplify_indexed();
+				return trONE * I * (lorentz_eps(ex_to<idx>(i1).replace_dim(_ex4), ex_to<idx>(i2).replace_dim(_ex4), ex_to<idx>(i3).replace_dim(_ex4), ex_to<idx>(i4).replace_dim(_ex4)) * b1 * b2 * b3 * b4).simplify_indexed(sp);
 			}
 
 	   		// Tr gamma5 S_2k =
@@ -929,8 +974,9 @@ ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trO
 			for (size_t i=1; i<num; i++)
 				base_and_index(e.op(i), bv[i-1], ix[i-1]);
 			num--;
+			trace_engine traces(ix, bv, sp);
 			int *iv = new int[num];
-			ex result;
+			exvector terms;
 			for (size_t i=0; i<num-3; i++) {
 				ex idx1 = ix[i];
 				for (size_t j=i+1; j<num-2; j++) {
@@ -940,23 +986,21 @@ ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trO
 						for (size_t l=k+1; l<num; l++) {
 							ex idx4 = ix[l];
 							iv[0] = i; iv[1] = j; iv[2] = k; iv[3] = l;
-							exvector v;
-							v.reserve(num - 4);
 							for (size_t n=0, t=4; n<num; n++) {
 								if (n == i || n == j || n == k || n == l)
 									continue;
 								iv[t++] = n;
-								v.push_back(ix[n]);
 							}
 							int sign = permutation_sign(iv, iv + num);
-							result += sign * lorentz_eps(ex_to<idx>(idx1).replace_dim(_ex4), ex_to<idx>(idx2).replace_dim(_ex4), ex_to<idx>(idx3).replace_dim(_ex4), ex_to<idx>(idx4).replace_dim(_ex4))
-							        * trace_string(v.begin(), num - 4);
+							const unsigned long rest = traces.all() & ~(1UL << i) & ~(1UL << j) & ~(1UL << k) & ~(1UL << l);
+							terms.push_back(sign * lorentz_eps(ex_to<idx>(idx1).replace_dim(_ex4), ex_to<idx>(idx2).replace_dim(_ex4), ex_to<idx>(idx3).replace_dim(_ex4), ex_to<idx>(idx4).replace_dim(_ex4))
+							                * bv[i] * bv[j] * bv[k] * bv[l] * traces.trace(rest));
 						}
 					}
 				}
 			}
 			delete[] iv;
-			return trONE * I * result * mul(bv);
+			return trONE * I * (new add(terms))->setflag(status_flags::dynallocated);
 
 		} else { // no gamma5
 
@@ -964,32 +1008,30 @@ ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trO
 			if ((num & 1) == 1)
 				return _ex0;
 
-			// Tr gamma.mu gamma.nu = 4 g.mu.nu
-			if (num == 2) {
-				ex b1, i1, b2, i2;
-				base_and_index(e.op(0), b1, i1);
-				base_and_index(e.op(1), b2, i2);
-				return trONE * (lorentz_g(i1, i2) * b1 * b2).simplify_indexed();
-			}
-
 			exvector iv(num), bv(num);
 			for (size_t i=0; i<num; i++)
 				base_and_index(e.op(i), bv[i], iv[i]);
 
-			return trONE * (trace_string(iv.begin(), num) * mul(bv)).simplify_indexed();
+			trace_engine traces(iv, bv, sp);
+			return trONE * traces.trace(traces.all()).simplify_indexed(sp);
 		}
 
 	} else if (e.nops() > 0) {
 
 		// Trace maps to all other container classes (this includes sums)
-		pointer_to_map_function_2args<const std::set<unsigned char> &, const ex &> fcn(dirac_trace, rls, trONE);
+		pointer_to_map_function_3args<const std::set<unsigned char> &, const scalar_products &, const ex &> fcn(dirac_trace, rls, sp, trONE);
 		return e.map(fcn);
 
 	} else
 		return _ex0;
 }
 
-ex dirac_trace(const ex & e, const lst & rll, const ex & trONE)
+ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const ex & trONE)
+{
+	return dirac_trace(e, rls, scalar_products(), trONE);
+}
+
+ex dirac_trace(const ex & e, const lst & rll, const scalar_products & sp, const ex & trONE)
 {
 	// Convert list to set
 	std::set<unsigned char> rls;
@@ -998,16 +1040,26 @@ ex dirac_trace(const ex & e, const lst & rll, const ex & trONE)
 			rls.insert(ex_to<numeric>(*i).to_int());
 	}
 
-	return dirac_trace(e, rls, trONE);
+	return dirac_trace(e, rls, sp, trONE);
 }
 
-ex dirac_trace(const ex & e, unsigned char rl, const ex & trONE)
+ex dirac_trace(const ex & e, const lst & rll, const ex & trONE)
+{
+	return dirac_trace(e, rll, scalar_products(), trONE);
+}
+
+ex dirac_trace(const ex & e, unsigned char rl, const scalar_products & sp, const ex & trONE)
 {
 	// Convert label to set
 	std::set<unsigned char> rls;
 	rls.insert(rl);
 
-	return dirac_trace(e, rls, trONE);
+	return dirac_trace(e, rls, sp, trONE);
+}
+
+ex dirac_trace(const ex & e, unsigned char rl, const ex & trONE)
+{
+	return dirac_trace(e, rl, scalar_products(), trONE);
 }
 
 
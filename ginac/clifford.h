@@ -271,6 +271,37 @@ ex dirac_trace(const ex & e, const lst & rll, const ex & trONE = 4);
  *  @param trONE Expression to be returned as the trace of the unit matrix */
 ex dirac_trace(const ex & e, unsigned char rl = 0, const ex & trONE = 4);
 
+/** Calculate dirac traces over the specified set of representation labels,
+ *  and replace the products of slashed vectors and gammas arising in the
+ *  traces by the given scalar products right away.  This is much faster
+ *  than taking the trace and calling simplify_indexed() on it for long
+ *  strings of slashed vectors.
+ *
+ *  @param e Expression to take the trace of
+ *  @param rls Set of representation labels
+ *  @param sp Scalar products
+ *  @param trONE Expression to be returned as the trace of the unit matrix */
+ex dirac_trace(const ex & e, const std::set<unsigned char> & rls, const scalar_products & sp, const ex & trONE = 4);
+
+/** Calculate dirac traces over the specified list of representation labels,
+ *  using the given scalar products right away.
+ *
+ *  @param e Expression to take the trace of
+ *  @param rll List of representation labels
+ *  @param sp Scalar products
+ *  @param trONE Expression to be returned as the trace of the unit matrix */
+ex dirac_trace(const ex & e, const lst & rll, const scalar_products & sp, const ex & trONE = 4);
+
+/** Calculate the trace of an expression containing gamma objects with
+ *  a specified representation label, using the given scalar products
+ *  right away.
+ *
+ *  @param e Expression to take the trace of
+ *  @param rl Representation label
+ *  @param sp Scalar products
+ *  @param trONE Expression to be returned as the trace of the unit matrix */
+ex dirac_trace(const ex & e, unsigned char rl, const scalar_products & sp, const ex & trONE = 4);
+
 /** Bring all products of clifford objects in an expression into a canonical
  *  order. This is not necessarily the most simple form but it will allow
  *  to check two expressions for equality. */
@@ -32,8 +32,11 @@
 #include "archive.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <stdexcept>
+#include <vector>
 
 namespace GiNaC {
 
@@ -535,6 +538,207 @@ static unsigned char get_representation_label(const return_type_t& ti)
 	return (unsigned char)ti.rl;
 }
 
+namespace {
+
+/** Trace of a string of generators of SU(N) with free indices, computed
+ *  recursively by
+ *    Tr T_a1 .. T_an =
+ *        1/(2N) delta_a(n-1)_an Tr T_a1 .. T_a(n-2)
+ *      + 1/2 h_a(n-1)_an_k Tr T_a1 .. T_a(n-2) T_k */
+ex free_trace(const exvector & iv, const ex & N)
+{
+	const size_t num = iv.size();
+	if (num == 0)
+		return N;
+	else if (num == 1)
+		return _ex0;
+	else if (num == 2)
+		return delta_tensor(iv[0], iv[1]) / 2;
+	else if (num == 3)
+		return color_h(iv[0], iv[1], iv[2]) / 4;
+
+	idx summation_index((new symbol)->setflag(status_flags::dynallocated), 8);
+	exvector v1(iv.begin(), iv.end() - 2);
+	exvector v2 = v1;
+	v2.push_back(summation_index);
+	return delta_tensor(iv[num-2], iv[num-1]) * free_trace(v1, N) / (2*N)
+	       + color_h(iv[num-2], iv[num-1], summation_index) * free_trace(v2, N) / 2;
+}
+
+/** A string of generators under a trace, given by labels of their indices.
+ *  Labels below the number of free indices stand for these, all others
+ *  stand for summed indices, which appear exactly twice in a product. */
+typedef std::vector<int> color_word;
+
+/** A product of traces. */
+typedef std::vector<color_word> color_words;
+
+/** Products of traces of generators of SU(N), with the summed indices
+ *  contracted by the Fierz identity
+ *    T_a[i,j] T_a[k,l] = 1/2 (delta[i,l] delta[k,j] - 1/N delta[i,j] delta[k,l]),
+ *  that is
+ *    Tr(T_a B T_a C) = 1/2 Tr(B) Tr(C) - 1/(2N) Tr(B C),
+ *    Tr(X T_a) Tr(Y T_a) = 1/2 Tr(X Y) - 1/(2N) Tr(X) Tr(Y).
+ *  Every step removes one summed index, which may leave another one shared
+ *  by two traces, so the states are products of traces.  They are brought
+ *  into a canonical form (each trace rotated, the traces sorted, the summed
+ *  indices renamed), and the results for them are remembered, since the
+ *  same products arise on many paths. */
+class fierz_tracer {
+public:
+	fierz_tracer(const exvector & free_indices, const ex & N_) : free(free_indices), N(N_) {}
+
+	ex trace(color_words w);
+
+private:
+	int num_free() const { return int(free.size()); }
+	int masked(int label) const { return label < num_free() ? label : num_free(); }
+	bool less_masked(const color_word & a, const color_word & b) const;
+	void canonicalize(color_words & w) const;
+
+	exvector free;
+	ex N;
+	std::map<color_words, ex> memo;
+};
+
+/** Compare words, taking all summed indices as equal. */
+bool fierz_tracer::less_masked(const color_word & a, const color_word & b) const
+{
+	if (a.size() != b.size())
+		return a.size() < b.size();
+	for (size_t i=0; i<a.size(); i++)
+		if (masked(a[i]) != masked(b[i]))
+			return masked(a[i]) < masked(b[i]);
+	return false;
+}
+
+void fierz_tracer::canonicalize(color_words & w) const
+{
+	// Rotate each trace to its smallest form
+	for (color_words::iterator i = w.begin(); i != w.end(); ++i) {
+		color_word best = *i, r = *i;
+		for (size_t j=1; j<r.size(); j++) {
+			std::rotate(r.begin(), r.begin() + 1, r.end());
+			if (less_masked(r, best))
+				best = r;
+		}
+		i->swap(best);
+	}
+
+	// Sort the traces (there are only a few)
+	for (size_t i=1; i<w.size(); i++)
+		for (size_t j=i; j>0 && less_masked(w[j], w[j-1]); j--)
+			w[j].swap(w[j-1]);
+
+	// Number the summed indices in order of appearance
+	std::map<int, int> renamed;
+	int next = num_free();
+	for (color_words::iterator i = w.begin(); i != w.end(); ++i)
+		for (color_word::iterator j = i->begin(); j != i->end(); ++j)
+			if (*j >= num_free()) {
+				std::map<int, int>::const_iterator r = renamed.find(*j);
+				if (r == renamed.end())
+					*j = renamed[*j] = next++;
+				else
+					*j = r->second;
+			}
+}
+
+ex fierz_tracer::trace(color_words w)
+{
+	// Tr ONE = N, Tr T_a = 0
+	ex factor = _ex1;
+	for (size_t i=0; i<w.size(); ) {
+		if (w[i].empty()) {
+			factor *= N;
+			w.erase(w.begin() + i);
+		} else if (w[i].size() == 1)
+			return _ex0;
+		else
+			i++;
+	}
+
+	canonicalize(w);
+	std::map<color_words, ex>::const_iterator found = memo.find(w);
+	if (found != memo.end())
+		return factor * found->second;
+
+	// Find the first summed index and its partner
+	size_t w1 = 0, p1 = 0, w2 = 0, p2 = 0;
+	bool summed = false;
+	for (size_t i=0; i<w.size() && !summed; i++) {
+		for (size_t j=0; j<w[i].size(); j++) {
+			if (w[i][j] >= num_free()) {
+				w1 = i; p1 = j;
+				summed = true;
+				break;
+			}
+		}
+	}
+
+	ex result;
+	if (!summed) {
+
+		result = _ex1;
+		for (size_t i=0; i<w.size(); i++) {
+			exvector iv;
+			iv.reserve(w[i].size());
+			for (size_t j=0; j<w[i].size(); j++)
+				iv.push_back(free[w[i][j]]);
+			result *= free_trace(iv, N);
+		}
+
+	} else {
+
+		const int label = w[w1][p1];
+		for (size_t i=w1; i<w.size(); i++)
+			for (size_t j=(i == w1 ? p1+1 : 0); j<w[i].size(); j++)
+				if (w[i][j] == label) {
+					w2 = i; p2 = j;
+				}
+
+		color_words joined, split;
+		for (size_t i=0; i<w.size(); i++)
+			if (i != w1 && i != w2)
+				joined.push_back(w[i]);
+		split = joined;
+
+		const color_word & a = w[w1];
+		const color_word & b = w[w2];
+		if (w1 == w2) {
+
+			// Tr(T_a B T_a C) = 1/2 Tr(B) Tr(C) - 1/(2N) Tr(B C)
+			color_word B(a.begin() + p1 + 1, a.begin() + p2);
+			color_word C(a.begin() + p2 + 1, a.end());
+			C.insert(C.end(), a.begin(), a.begin() + p1);
+			split.push_back(B);
+			split.push_back(C);
+			B.insert(B.end(), C.begin(), C.end());
+			joined.push_back(B);
+			result = trace(split) / 2 - trace(joined) / (2*N);
+
+		} else {
+
+			// Tr(X T_a) Tr(Y T_a) = 1/2 Tr(X Y) - 1/(2N) Tr(X) Tr(Y)
+			color_word X(a.begin() + p1 + 1, a.end());
+			X.insert(X.end(), a.begin(), a.begin() + p1);
+			color_word Y(b.begin() + p2 + 1, b.end());
+			Y.insert(Y.end(), b.begin(), b.begin() + p2);
+			split.push_back(X);
+			split.push_back(Y);
+			X.insert(X.end(), Y.begin(), Y.end());
+			joined.push_back(X);
+			result = trace(joined) / 2 - trace(split) / (2*N);
+		}
+	}
+
+	result = result.expand();
+	memo[w] = result;
+	return factor * result;
+}
+
+} // anonymous namespace
+
 ex color_trace(const ex & e, const std::set<unsigned char> & rls)
 {
 	if (is_a<color>(e)) {
@@ -642,4 +846,118 @@ ex color_trace(const ex & e, unsigned char rl)
 	return color_trace(e, rls);
 }
 
+ex color_trace(const ex & e, const std::set<unsigned char> & rls, const ex & N)
+{
+	if (is_a<color>(e)) {
+
+		unsigned char rl = ex_to<color>(e).get_representation_label();
+
+		// Are we taking the trace over this object's representation label?
+		if (rls.find(rl) == rls.end())
+			return e;
+
+		// Yes, all generators are traceless, except for color_ONE
+		if (is_a<su3one>(e.op(0)))
+			return N;
+		else
+			return _ex0;
+
+	} else if (is_exactly_a<mul>(e)) {
+
+		// Trace of product: pull out non-color factors
+		ex prod = _ex1;
+		for (size_t i=0; i<e.nops(); i++) {
+			const ex &o = e.op(i);
+			if (is_color_tinfo(o.return_type_tinfo()))
+				prod *= color_trace(o, rls, N);
+			else
+				prod *= o;
+		}
+		return prod;
+
+	} else if (is_exactly_a<ncmul>(e)) {
+
+		unsigned char rl = get_representation_label(e.return_type_tinfo());
+
+		// Are we taking the trace over this string's representation label?
+		if (rls.find(rl) == rls.end())
+			return e;
+
+		// Yes, expand product if necessary
+		ex e_expanded = e.expand();
+		if (!is_a<ncmul>(e_expanded))
+			return color_trace(e_expanded, rls, N);
+
+		// Label the indices, symbolic ones appearing twice are summed over
+		exvector iv;
+		iv.reserve(e_expanded.nops());
+		for (size_t i=0; i<e_expanded.nops(); i++) {
+			// Skip unity elements
+			const ex &o = e_expanded.op(i);
+			if (is_a<su3t>(o.op(0)))
+				iv.push_back(o.op(1));
+		}
+		size_t num = iv.size();
+
+		exvector free;
+		color_word word(num);
+		std::vector<bool> done(num, false);
+		int next_summed = 0;
+		for (size_t i=0; i<num; i++) {
+			if (done[i])
+				continue;
+			size_t partner = num, count = 1;
+			if (ex_to<idx>(iv[i]).is_symbolic()) {
+				for (size_t j=i+1; j<num; j++)
+					if (iv[j].is_equal(iv[i])) {
+						partner = j;
+						count++;
+					}
+			}
+			if (count == 2) {
+				word[i] = word[partner] = -1 - next_summed++;
+				done[partner] = true;
+			} else {
+				word[i] = int(free.size());
+				free.push_back(iv[i]);
+			}
+		}
+		for (size_t i=0; i<num; i++)
+			if (word[i] < 0)
+				word[i] = int(free.size()) - 1 - word[i];
+
+		fierz_tracer tracer(free, N);
+		return tracer.trace(color_words(1, word));
+
+	} else if (e.nops() > 0) {
+
+		// Trace maps to all other container classes (this includes sums)
+		pointer_to_map_function_2args<const std::set<unsigned char> &, const ex &> fcn(color_trace, rls, N);
+		return e.map(fcn);
+
+	} else
+		return _ex0;
+}
+
+ex color_trace(const ex & e, const lst & rll, const ex & N)
+{
+	// Convert list to set
+	std::set<unsigned char> rls;
+	for (lst::const_iterator i = rll.begin(); i != rll.end(); ++i) {
+		if (i->info(info_flags::nonnegint))
+			rls.insert(ex_to<numeric>(*i).to_int());
+	}
+
+	return color_trace(e, rls, N);
+}
+
+ex color_trace(const ex & e, unsigned char rl, const ex & N)
+{
+	// Convert label to set
+	std::set<unsigned char> rls;
+	rls.insert(rl);
+
+	return color_trace(e, rls, N);
+}
+
 } // namespace GiNaC
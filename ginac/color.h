@@ -191,6 +191,33 @@ ex color_trace(const ex & e, const lst & rll);
  *  @param rl Representation label */
 ex color_trace(const ex & e, unsigned char rl = 0);
 
+/** Calculate color traces over the specified set of representation labels
+ *  for the group SU(N).  Summed indices are contracted by the Fierz identity,
+ *  so the result is a polynomial in N times the delta and h tensors of the
+ *  free indices.  (The contraction rules of simplify_indexed() for the d and
+ *  f tensors remain those of SU(3).)
+ *
+ *  @param e Expression to take the trace of
+ *  @param rls Set of representation labels
+ *  @param N Dimension of the fundamental representation */
+ex color_trace(const ex & e, const std::set<unsigned char> & rls, const ex & N);
+
+/** Calculate color traces over the specified list of representation labels
+ *  for the group SU(N).
+ *
+ *  @param e Expression to take the trace of
+ *  @param rll List of representation labels
+ *  @param N Dimension of the fundamental representation */
+ex color_trace(const ex & e, const lst & rll, const ex & N);
+
+/** Calculate the trace of an expression containing color objects with a
+ *  specified representation label for the group SU(N).
+ *
+ *  @param e Expression to take the trace of
+ *  @param rl Representation label
+ *  @param N Dimension of the fundamental representation */
+ex color_trace(const ex & e, unsigned char rl, const ex & N);
+
 } // namespace GiNaC
 
 #endif // ndef GINAC_COLOR_H
@@ -31,6 +31,16 @@
 #define likely(cond) (cond)
 #endif
 
+// Storage class of variables with one instance per thread (only for
+// pointers and other plain old data)
+#if defined(__GNUC__)
+#define GINAC_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define GINAC_THREAD_LOCAL __declspec(thread)
+#else
+#define GINAC_THREAD_LOCAL
+#endif
+
 #ifdef _MSC_VER
 #define __func__ __FUNCTION__
 #define __alignof__ __alignof
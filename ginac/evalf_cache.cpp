@@ -0,0 +1,441 @@
+/** @file evalf_cache.cpp
+ *
+ *  Implementation of the persistent cache of numerical function values. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "evalf_cache.h"
+#include "archive.h"
+#include "ex.h"
+#include "lst.h"
+#include "numeric.h"
+#include "symbol.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace GiNaC {
+
+/*
+ *  Cache file format
+ *
+ *   - 4 bytes signature 'GEVC'
+ *   - unsigned version number
+ *   - unsigned generation, incremented whenever the file is rewritten
+ *   - records, each consisting of
+ *      - unsigned key length
+ *      - unsigned value length
+ *      - unsigned checksum of key and value
+ *      - key bytes: unsigned Digits followed by the archived function
+ *      - value bytes: the archived numerical value
+ *
+ *  Unsigned quantities are stored in the same compressed format as in
+ *  archives.  Records are only ever appended, each with a single write, so
+ *  readers may see an incomplete record at the end of the file, which they
+ *  skip until it is complete.  When the file is rewritten (to enforce the
+ *  size limit or to clear it), the new file is written under a temporary
+ *  name and renamed, and the generation tells other processes to reload it.
+ */
+
+namespace {
+
+const unsigned evalf_cache_version = 1;
+
+struct cache_state {
+	cache_state() : is_open(false), max_size(0), generation(0), read_pos(0) {}
+
+	bool is_open;
+	std::string filename;
+	std::size_t max_size;
+	unsigned generation;     ///< generation of the file the entries were read from
+	std::streamoff read_pos; ///< file position up to which records were read
+	std::map<std::string, std::string> entries;
+};
+
+cache_state & state()
+{
+	static cache_state s;
+	return s;
+}
+
+typedef std::vector<std::pair<std::string, std::string> > record_vector;
+
+enum read_status {
+	record_ok,
+	record_incomplete,
+	record_corrupt
+};
+
+void write_unsigned(std::ostream & os, unsigned val)
+{
+	while (val >= 0x80) {
+		os.put((val & 0x7f) | 0x80);
+		val >>= 7;
+	}
+	os.put(val);
+}
+
+bool read_unsigned(std::istream & is, unsigned & val)
+{
+	unsigned char b;
+	unsigned shift = 0;
+	val = 0;
+	do {
+		char b2;
+		if (!is.get(b2))
+			return false;
+		b = b2;
+		val |= (b & 0x7f) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return true;
+}
+
+/** FNV-1a hash of key and value, to detect damaged records. */
+unsigned checksum(const std::string & key, const std::string & value)
+{
+	unsigned h = 2166136261U;
+	for (std::string::const_iterator i = key.begin(); i != key.end(); ++i)
+		h = (h ^ (unsigned char)*i) * 16777619U;
+	for (std::string::const_iterator i = value.begin(); i != value.end(); ++i)
+		h = (h ^ (unsigned char)*i) * 16777619U;
+	return h & 0xffffffffU;
+}
+
+void write_header(std::ostream & os, unsigned generation)
+{
+	os.put('G');
+	os.put('E');
+	os.put('V');
+	os.put('C');
+	write_unsigned(os, evalf_cache_version);
+	write_unsigned(os, generation);
+}
+
+bool read_header(std::istream & is, unsigned & generation)
+{
+	char c1, c2, c3, c4;
+	is.get(c1).get(c2).get(c3).get(c4);
+	if (!is || c1 != 'G' || c2 != 'E' || c3 != 'V' || c4 != 'C')
+		return false;
+	unsigned version;
+	if (!read_unsigned(is, version) || version != evalf_cache_version)
+		return false;
+	return read_unsigned(is, generation);
+}
+
+std::string encode_record(const std::string & key, const std::string & value)
+{
+	std::ostringstream os;
+	write_unsigned(os, key.size());
+	write_unsigned(os, value.size());
+	write_unsigned(os, checksum(key, value));
+	os << key << value;
+	return os.str();
+}
+
+read_status read_record(std::istream & is, std::string & key, std::string & value)
+{
+	unsigned key_len, value_len, check;
+	if (!read_unsigned(is, key_len) || !read_unsigned(is, value_len) || !read_unsigned(is, check))
+		return record_incomplete;
+	key.resize(key_len);
+	value.resize(value_len);
+	if (key_len && !is.read(&key[0], key_len))
+		return record_incomplete;
+	if (value_len && !is.read(&value[0], value_len))
+		return record_incomplete;
+	if (checksum(key, value) != check)
+		return record_corrupt;
+	return record_ok;
+}
+
+/** Read the records appended to the cache file since the last call.
+ *  @return false if the file is not an evalf cache */
+bool sync()
+{
+	cache_state & s = state();
+	std::ifstream is(s.filename.c_str(), std::ios::in | std::ios::binary);
+	if (!is)
+		return true;  // removed by someone else, keep what we have
+
+	unsigned generation;
+	if (!read_header(is, generation))
+		return false;
+	if (generation != s.generation || s.read_pos == 0) {
+		s.entries.clear();
+		s.generation = generation;
+		s.read_pos = is.tellg();
+	}
+
+	is.seekg(s.read_pos);
+	std::string key, value;
+	while (true) {
+		read_status status = read_record(is, key, value);
+		if (status == record_incomplete)
+			break;
+		if (status == record_corrupt) {
+			// Cannot resynchronize, ignore the rest of the file
+			is.clear();
+			is.seekg(0, std::ios::end);
+			s.read_pos = is.tellg();
+			break;
+		}
+		s.entries[key] = value;
+		s.read_pos = is.tellg();
+	}
+	return true;
+}
+
+std::streamoff file_size(const std::string & filename)
+{
+	std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!is)
+		return 0;
+	is.seekg(0, std::ios::end);
+	return is.tellg();
+}
+
+/** Name for a new file next to the cache file.  It contains the process ID,
+ *  so processes that rewrite the same cache at the same time don't write to
+ *  the same file; rename() then replaces the cache file atomically. */
+std::string temporary_name(const std::string & filename)
+{
+	static unsigned count = 0;
+#ifdef _WIN32
+	const long pid = _getpid();
+#else
+	const long pid = getpid();
+#endif
+	std::ostringstream os;
+	os << filename << ".tmp." << pid << '.' << count++;
+	return os.str();
+}
+
+/** Replace the cache file by one containing the given records. */
+void rewrite(const record_vector & records)
+{
+	cache_state & s = state();
+	sync();
+	const unsigned generation = s.generation + 1;
+
+	const std::string tmpname = temporary_name(s.filename);
+	{
+		std::ofstream os(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!os)
+			throw std::runtime_error("evalf_cache: cannot write " + tmpname);
+		write_header(os, generation);
+		for (record_vector::const_iterator i = records.begin(); i != records.end(); ++i)
+			os << encode_record(i->first, i->second);
+		os.flush();
+		if (!os) {
+			os.close();
+			std::remove(tmpname.c_str());
+			throw std::runtime_error("evalf_cache: cannot write " + tmpname);
+		}
+	}
+	if (std::rename(tmpname.c_str(), s.filename.c_str()) != 0) {
+		std::remove(s.filename.c_str());
+		if (std::rename(tmpname.c_str(), s.filename.c_str()) != 0)
+			throw std::runtime_error("evalf_cache: cannot replace " + s.filename);
+	}
+
+	s.entries.clear();
+	s.generation = generation;
+	s.read_pos = 0;
+	sync();
+}
+
+/** Rewrite the cache file with the most recent entries that fit into half
+ *  the size limit. */
+void shrink()
+{
+	cache_state & s = state();
+	std::ifstream is(s.filename.c_str(), std::ios::in | std::ios::binary);
+	unsigned generation;
+	record_vector records;
+	if (is && read_header(is, generation)) {
+		std::string key, value;
+		while (read_record(is, key, value) == record_ok)
+			records.push_back(std::make_pair(key, value));
+	}
+	is.close();
+
+	// Walk backwards so that the latest record of each key is kept
+	const std::size_t budget = s.max_size / 2;
+	std::size_t used = 0;
+	std::set<std::string> seen;
+	record_vector kept;
+	for (record_vector::reverse_iterator i = records.rbegin(); i != records.rend(); ++i) {
+		if (!seen.insert(i->first).second)
+			continue;
+		used += encode_record(i->first, i->second).size();
+		if (used > budget)
+			break;
+		kept.push_back(*i);
+	}
+	rewrite(record_vector(kept.rbegin(), kept.rend()));
+}
+
+void append(const std::string & key, const std::string & value)
+{
+	cache_state & s = state();
+	const std::string record = encode_record(key, value);
+
+	if (s.max_size && std::size_t(file_size(s.filename)) + record.size() > s.max_size)
+		shrink();
+
+	// Unbuffered, so that the record goes to the file in one piece
+	std::ofstream os;
+	os.rdbuf()->pubsetbuf(0, 0);
+	os.open(s.filename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+	os.write(record.data(), record.size());
+}
+
+bool has_symbol(const ex & e)
+{
+	if (is_a<symbol>(e))
+		return true;
+	for (size_t i = 0; i < e.nops(); ++i)
+		if (has_symbol(e.op(i)))
+			return true;
+	return false;
+}
+
+bool make_key(const ex & f, std::string & key)
+{
+	if (has_symbol(f))
+		return false;
+	std::ostringstream os;
+	write_unsigned(os, long(Digits));
+	os << archive(f);
+	key = os.str();
+	return true;
+}
+
+} // anonymous namespace
+
+void evalf_cache::open(const std::string & filename, std::size_t max_size)
+{
+	close();
+
+	cache_state & s = state();
+	{
+		std::ofstream os(filename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+		if (!os)
+			throw std::runtime_error("evalf_cache::open(): cannot open " + filename);
+		if (os.tellp() == 0)
+			write_header(os, 0);
+	}
+
+	s.filename = filename;
+	s.max_size = max_size;
+	if (!sync()) {
+		s.filename.clear();
+		throw std::runtime_error("evalf_cache::open(): " + filename + " is not an evalf cache");
+	}
+	s.is_open = true;
+}
+
+void evalf_cache::close()
+{
+	cache_state & s = state();
+	s.is_open = false;
+	s.filename.clear();
+	s.generation = 0;
+	s.read_pos = 0;
+	s.entries.clear();
+}
+
+void evalf_cache::clear()
+{
+	if (is_open())
+		rewrite(record_vector());
+}
+
+bool evalf_cache::is_open()
+{
+	return state().is_open;
+}
+
+std::size_t evalf_cache::size()
+{
+	return state().entries.size();
+}
+
+bool evalf_cache::lookup(const ex & f, ex & result)
+{
+	cache_state & s = state();
+	if (!s.is_open)
+		return false;
+
+	std::string key;
+	if (!make_key(f, key))
+		return false;
+
+	std::map<std::string, std::string>::iterator i = s.entries.find(key);
+	if (i == s.entries.end()) {
+		// Maybe another process has computed it in the meantime
+		sync();
+		i = s.entries.find(key);
+		if (i == s.entries.end())
+			return false;
+	}
+
+	try {
+		std::istringstream is(i->second);
+		archive ar;
+		is >> ar;
+		result = ar.unarchive_ex(lst());
+	} catch (std::exception &) {
+		s.entries.erase(i);
+		return false;
+	}
+	return true;
+}
+
+void evalf_cache::store(const ex & f, const ex & result)
+{
+	cache_state & s = state();
+	if (!s.is_open || !is_exactly_a<numeric>(result))
+		return;
+
+	std::string key;
+	if (!make_key(f, key) || s.entries.find(key) != s.entries.end())
+		return;
+
+	std::ostringstream os;
+	os << archive(result);
+	const std::string value = os.str();
+	s.entries[key] = value;
+	append(key, value);
+}
+
+} // namespace GiNaC
@@ -0,0 +1,77 @@
+/** @file evalf_cache.h
+ *
+ *  Interface to the persistent cache of numerical function values. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_EVALF_CACHE_H
+#define GINAC_EVALF_CACHE_H
+
+#include <cstddef>
+#include <string>
+
+namespace GiNaC {
+
+class ex;
+
+/** Persistent cache for numerical values of functions that are expensive to
+ *  evaluate, like the polylogarithms and zeta values.  Functions registered
+ *  with the persistent_evalf() option look up their numerical values in the
+ *  cache before evaluating them, and store the results afterwards.  The key
+ *  of an entry is the archived function together with the current value of
+ *  Digits, the value is the archived result.
+ *
+ *  The cache lives in a file.  New entries are only ever appended to it, so
+ *  several processes can use the same file at the same time; each process
+ *  picks up the entries written by the others when it misses.  If a size
+ *  limit is given, the file is rewritten with the most recent entries only
+ *  when it would exceed the limit.  The cache is off until open() is
+ *  called. */
+class evalf_cache {
+public:
+	/** Use the given file as cache, creating it if it does not exist.
+	 *  @param filename name of the cache file
+	 *  @param max_size maximum size of the file in bytes, 0 means unlimited
+	 *  @exception runtime_error (file is not an evalf cache) */
+	static void open(const std::string & filename, std::size_t max_size = 0);
+
+	/** Stop using the cache.  The file is kept. */
+	static void close();
+
+	/** Remove all entries from the cache and its file. */
+	static void clear();
+
+	static bool is_open();
+
+	/** Number of entries currently known to this process. */
+	static std::size_t size();
+
+	/** Look up the numerical value of a function for the current Digits.
+	 *  @return true if a value was found and stored in result */
+	static bool lookup(const ex & f, ex & result);
+
+	/** Store the numerical value of a function for the current Digits.
+	 *  Results that are not numbers and functions with symbolic arguments
+	 *  are ignored. */
+	static void store(const ex & f, const ex & result);
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_EVALF_CACHE_H
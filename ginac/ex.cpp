@@ -30,6 +30,7 @@
 #include "lst.h"
 #include "relational.h"
 #include "utils.h"
+#include "pattern_set.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -74,8 +75,9 @@ ex ex::expand(unsigned options) const
 {
 	if (options == 0 && (bp->flags & status_flags::expanded)) // The "expanded" flag only covers the standard options; someone might want to re-expand with different options
 		return *this;
-	else
-		return bp->expand(options);
+
+	profile_scope prof(profiled_ops::expand);
+	return bp->expand(options);
 }
 
 /** Compute partial derivative of an expression.
@@ -115,6 +117,42 @@ bool ex::find(const ex & pattern, exset& found) const
 	return any_found;
 }
 
+/** Check whether the expression or one of its subexpressions matches any
+ *  pattern of a set.
+ *
+ *  @see pattern_set */
+bool ex::has(const pattern_set & patterns, unsigned options) const
+{
+	return patterns.has(*this, options);
+}
+
+/** Find all occurrences of any pattern of a set, traversing the expression
+ *  only once.
+ *
+ *  @see pattern_set */
+bool ex::find(const pattern_set & patterns, exset& found) const
+{
+	return patterns.find(*this, found);
+}
+
+/** Check whether the expression matches any pattern of a set.  The position
+ *  of the first matching pattern is returned in "which".
+ *
+ *  @see pattern_set */
+bool ex::match(const pattern_set & patterns, exmap & repls, size_t & which) const
+{
+	return patterns.match(*this, repls, which);
+}
+
+/** Substitute objects in an expression (syntactic substitution) and return
+ *  the result as a new expression.  Subexpressions shared between several
+ *  parts of the expression are substituted only once. */
+ex ex::subs(const exmap & m, unsigned options) const
+{
+	profile_scope prof(profiled_ops::subs);
+	return subs_with_memo(*this, m, options);
+}
+
 /** Substitute objects in an expression (syntactic substitution) and return
  *  the result as a new expression. */
 ex ex::subs(const lst & ls, const lst & lr, unsigned options) const
@@ -134,7 +172,7 @@ ex ex::subs(const lst & ls, const lst & lr, unsigned options) const
 	if (!(options & subs_options::pattern_is_product))
 		options |= subs_options::pattern_is_not_product;
 
-	return bp->subs(m, options);
+	return subs(m, options);
 }
 
 /** Substitute objects in an expression (syntactic substitution) and return
@@ -155,7 +193,7 @@ ex ex::subs(const ex & e, unsigned options) const
 		else
 			options |= subs_options::pattern_is_not_product;
 
-		return bp->subs(m, options);
+		return subs(m, options);
 
 	} else if (e.info(info_flags::list)) {
 
@@ -177,7 +215,7 @@ ex ex::subs(const ex & e, unsigned options) const
 		if (!(options & subs_options::pattern_is_product))
 			options |= subs_options::pattern_is_not_product;
 
-		return bp->subs(m, options);
+		return subs(m, options);
 
 	} else
 		throw(std::invalid_argument("ex::subs(ex): argument must be a relation_equal or a list"));
@@ -336,6 +374,14 @@ ptr<basic> ex::construct_from_basic(const basic & other)
 			// another reference to it.
 			return ptr<basic>(const_cast<basic &>(other));
 
+		} else if (is_exactly_a<numeric>(other)
+		        && static_cast<const numeric &>(other).is_integer()
+		        && abs(static_cast<const numeric &>(other)) <= small_integer_max) {
+
+			// A small integer, for which there is a shared object.
+			long i = static_cast<const numeric &>(other).to_long();
+			return ptr<basic>(*const_cast<numeric *>(small_integer_numeric(i)));
+
 		} else {
 
 			// The object is not heap-allocated, so we create a duplicate
@@ -350,198 +396,50 @@ ptr<basic> ex::construct_from_basic(const basic & other)
 
 basic & ex::construct_from_int(int i)
 {
-	switch (i) {  // prefer flyweights over new objects
-	case -12:
-		return *const_cast<numeric *>(_num_12_p);
-	case -11:
-		return *const_cast<numeric *>(_num_11_p);
-	case -10:
-		return *const_cast<numeric *>(_num_10_p);
-	case -9:
-		return *const_cast<numeric *>(_num_9_p);
-	case -8:
-		return *const_cast<numeric *>(_num_8_p);
-	case -7:
-		return *const_cast<numeric *>(_num_7_p);
-	case -6:
-		return *const_cast<numeric *>(_num_6_p);
-	case -5:
-		return *const_cast<numeric *>(_num_5_p);
-	case -4:
-		return *const_cast<numeric *>(_num_4_p);
-	case -3:
-		return *const_cast<numeric *>(_num_3_p);
-	case -2:
-		return *const_cast<numeric *>(_num_2_p);
-	case -1:
-		return *const_cast<numeric *>(_num_1_p);
-	case 0:
-		return *const_cast<numeric *>(_num0_p);
-	case 1:
-		return *const_cast<numeric *>(_num1_p);
-	case 2:
-		return *const_cast<numeric *>(_num2_p);
-	case 3:
-		return *const_cast<numeric *>(_num3_p);
-	case 4:
-		return *const_cast<numeric *>(_num4_p);
-	case 5:
-		return *const_cast<numeric *>(_num5_p);
-	case 6:
-		return *const_cast<numeric *>(_num6_p);
-	case 7:
-		return *const_cast<numeric *>(_num7_p);
-	case 8:
-		return *const_cast<numeric *>(_num8_p);
-	case 9:
-		return *const_cast<numeric *>(_num9_p);
-	case 10:
-		return *const_cast<numeric *>(_num10_p);
-	case 11:
-		return *const_cast<numeric *>(_num11_p);
-	case 12:
-		return *const_cast<numeric *>(_num12_p);
-	default:
-		basic *bp = new numeric(i);
-		bp->setflag(status_flags::dynallocated);
-		GINAC_ASSERT(bp->get_refcount() == 0);
-		return *bp;
-	}
+	// prefer shared objects over new objects
+	if (i >= -small_integer_max && i <= small_integer_max)
+		return *const_cast<numeric *>(small_integer_numeric(i));
+
+	basic *bp = new numeric(i);
+	bp->setflag(status_flags::dynallocated);
+	GINAC_ASSERT(bp->get_refcount() == 0);
+	return *bp;
 }
 	
 basic & ex::construct_from_uint(unsigned int i)
 {
-	switch (i) {  // prefer flyweights over new objects
-	case 0:
-		return *const_cast<numeric *>(_num0_p);
-	case 1:
-		return *const_cast<numeric *>(_num1_p);
-	case 2:
-		return *const_cast<numeric *>(_num2_p);
-	case 3:
-		return *const_cast<numeric *>(_num3_p);
-	case 4:
-		return *const_cast<numeric *>(_num4_p);
-	case 5:
-		return *const_cast<numeric *>(_num5_p);
-	case 6:
-		return *const_cast<numeric *>(_num6_p);
-	case 7:
-		return *const_cast<numeric *>(_num7_p);
-	case 8:
-		return *const_cast<numeric *>(_num8_p);
-	case 9:
-		return *const_cast<numeric *>(_num9_p);
-	case 10:
-		return *const_cast<numeric *>(_num10_p);
-	case 11:
-		return *const_cast<numeric *>(_num11_p);
-	case 12:
-		return *const_cast<numeric *>(_num12_p);
-	default:
-		basic *bp = new numeric(i);
-		bp->setflag(status_flags::dynallocated);
-		GINAC_ASSERT(bp->get_refcount() == 0);
-		return *bp;
-	}
+	// prefer shared objects over new objects
+	if (i <= (unsigned long)small_integer_max)
+		return *const_cast<numeric *>(small_integer_numeric(i));
+
+	basic *bp = new numeric(i);
+	bp->setflag(status_flags::dynallocated);
+	GINAC_ASSERT(bp->get_refcount() == 0);
+	return *bp;
 }
 	
 basic & ex::construct_from_long(long i)
 {
-	switch (i) {  // prefer flyweights over new objects
-	case -12:
-		return *const_cast<numeric *>(_num_12_p);
-	case -11:
-		return *const_cast<numeric *>(_num_11_p);
-	case -10:
-		return *const_cast<numeric *>(_num_10_p);
-	case -9:
-		return *const_cast<numeric *>(_num_9_p);
-	case -8:
-		return *const_cast<numeric *>(_num_8_p);
-	case -7:
-		return *const_cast<numeric *>(_num_7_p);
-	case -6:
-		return *const_cast<numeric *>(_num_6_p);
-	case -5:
-		return *const_cast<numeric *>(_num_5_p);
-	case -4:
-		return *const_cast<numeric *>(_num_4_p);
-	case -3:
-		return *const_cast<numeric *>(_num_3_p);
-	case -2:
-		return *const_cast<numeric *>(_num_2_p);
-	case -1:
-		return *const_cast<numeric *>(_num_1_p);
-	case 0:
-		return *const_cast<numeric *>(_num0_p);
-	case 1:
-		return *const_cast<numeric *>(_num1_p);
-	case 2:
-		return *const_cast<numeric *>(_num2_p);
-	case 3:
-		return *const_cast<numeric *>(_num3_p);
-	case 4:
-		return *const_cast<numeric *>(_num4_p);
-	case 5:
-		return *const_cast<numeric *>(_num5_p);
-	case 6:
-		return *const_cast<numeric *>(_num6_p);
-	case 7:
-		return *const_cast<numeric *>(_num7_p);
-	case 8:
-		return *const_cast<numeric *>(_num8_p);
-	case 9:
-		return *const_cast<numeric *>(_num9_p);
-	case 10:
-		return *const_cast<numeric *>(_num10_p);
-	case 11:
-		return *const_cast<numeric *>(_num11_p);
-	case 12:
-		return *const_cast<numeric *>(_num12_p);
-	default:
-		basic *bp = new numeric(i);
-		bp->setflag(status_flags::dynallocated);
-		GINAC_ASSERT(bp->get_refcount() == 0);
-		return *bp;
-	}
+	// prefer shared objects over new objects
+	if (i >= -small_integer_max && i <= small_integer_max)
+		return *const_cast<numeric *>(small_integer_numeric(i));
+
+	basic *bp = new numeric(i);
+	bp->setflag(status_flags::dynallocated);
+	GINAC_ASSERT(bp->get_refcount() == 0);
+	return *bp;
 }
 	
 basic & ex::construct_from_ulong(unsigned long i)
 {
-	switch (i) {  // prefer flyweights over new objects
-	case 0:
-		return *const_cast<numeric *>(_num0_p);
-	case 1:
-		return *const_cast<numeric *>(_num1_p);
-	case 2:
-		return *const_cast<numeric *>(_num2_p);
-	case 3:
-		return *const_cast<numeric *>(_num3_p);
-	case 4:
-		return *const_cast<numeric *>(_num4_p);
-	case 5:
-		return *const_cast<numeric *>(_num5_p);
-	case 6:
-		return *const_cast<numeric *>(_num6_p);
-	case 7:
-		return *const_cast<numeric *>(_num7_p);
-	case 8:
-		return *const_cast<numeric *>(_num8_p);
-	case 9:
-		return *const_cast<numeric *>(_num9_p);
-	case 10:
-		return *const_cast<numeric *>(_num10_p);
-	case 11:
-		return *const_cast<numeric *>(_num11_p);
-	case 12:
-		return *const_cast<numeric *>(_num12_p);
-	default:
-		basic *bp = new numeric(i);
-		bp->setflag(status_flags::dynallocated);
-		GINAC_ASSERT(bp->get_refcount() == 0);
-		return *bp;
-	}
+	// prefer shared objects over new objects
+	if (i <= (unsigned long)small_integer_max)
+		return *const_cast<numeric *>(small_integer_numeric(i));
+
+	basic *bp = new numeric(i);
+	bp->setflag(status_flags::dynallocated);
+	GINAC_ASSERT(bp->get_refcount() == 0);
+	return *bp;
 }
 	
 basic & ex::construct_from_double(double d)
@@ -58,6 +58,7 @@ private:
 static library_init library_initializer;
 
 class scalar_products;
+class pattern_set;
 class const_iterator;
 class const_preorder_iterator;
 class const_postorder_iterator;
@@ -149,6 +150,9 @@ public:
 	bool find(const ex & pattern, exset& found) const;
 	bool match(const ex & pattern) const;
 	bool match(const ex & pattern, exmap & repls) const { return bp->match(pattern, repls); }
+	bool has(const pattern_set & patterns, unsigned options = 0) const;
+	bool find(const pattern_set & patterns, exset& found) const;
+	bool match(const pattern_set & patterns, exmap & repls, size_t & which) const;
 
 	// substitutions
 	ex subs(const exmap & m, unsigned options = 0) const;
@@ -182,7 +186,7 @@ public:
 	ex series(const ex & r, int order, unsigned options = 0) const;
 
 	// rational functions
-	ex normal(int level = 0) const;
+	ex normal(int level = 0, unsigned options = 0) const;
 	ex to_rational(exmap & repl) const;
 	ex to_rational(lst & repl_lst) const;
 	ex to_polynomial(exmap & repl) const;
@@ -736,8 +740,8 @@ inline ex denom(const ex & thisex)
 inline ex numer_denom(const ex & thisex)
 { return thisex.numer_denom(); }
 
-inline ex normal(const ex & thisex, int level=0)
-{ return thisex.normal(level); }
+inline ex normal(const ex & thisex, int level=0, unsigned options=0)
+{ return thisex.normal(level, options); }
 
 inline ex to_rational(const ex & thisex, lst & repl_lst)
 { return thisex.to_rational(repl_lst); }
@@ -814,11 +818,6 @@ inline bool is_zero(const ex & thisex)
 inline void swap(ex & e1, ex & e2)
 { e1.swap(e2); }
 
-inline ex ex::subs(const exmap & m, unsigned options) const
-{
-	return bp->subs(m, options);
-}
-
 inline ex subs(const ex & thisex, const exmap & m, unsigned options = 0)
 { return thisex.subs(m, options); }
 
@@ -375,6 +375,50 @@ ex expairseq::conjugate() const
 	return result;
 }
 
+namespace {
+
+/** Look for an augmenting path starting at pattern term i in the bipartite
+ *  graph of pattern terms and candidate terms (Kuhn's algorithm).  owner[j]
+ *  is one plus the pattern term the term j is assigned to, or 0. */
+bool augment(size_t i, const std::vector<std::vector<size_t> > & cands,
+             std::vector<bool> & seen, std::vector<size_t> & owner)
+{
+	for (std::vector<size_t>::const_iterator j = cands[i].begin(); j != cands[i].end(); ++j) {
+		if (seen[*j])
+			continue;
+		seen[*j] = true;
+		if (owner[*j] == 0 || augment(owner[*j] - 1, cands, seen, owner)) {
+			owner[*j] = i + 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Check whether every pattern term can be assigned a candidate term of its
+ *  own, disregarding the wildcards they have in common. */
+bool has_complete_matching(const std::vector<std::vector<size_t> > & cands, size_t num_terms)
+{
+	std::vector<size_t> owner(num_terms, 0);
+	for (size_t i=0; i<cands.size(); i++) {
+		std::vector<bool> seen(num_terms, false);
+		if (!augment(i, cands, seen, owner))
+			return false;
+	}
+	return true;
+}
+
+/** Order on pattern terms by the number of their candidate terms. */
+class fewer_candidates {
+public:
+	fewer_candidates(const std::vector<std::vector<size_t> > & cands_) : cands(cands_) {}
+	bool operator()(size_t a, size_t b) const { return cands[a].size() < cands[b].size(); }
+private:
+	const std::vector<std::vector<size_t> > & cands;
+};
+
+} // anonymous namespace
+
 bool expairseq::match(const ex & pattern, exmap & repl_lst) const
 {
 	// This differs from basic::match() because we want "a+b+c+d" to
@@ -400,71 +444,126 @@ bool expairseq::match(const ex & pattern, exmap & repl_lst) const
 		// does. So, save repl_lst in order to not add bogus entries.
 		exmap tmp_repl = repl_lst;
 
-		// Unfortunately, this is an O(N^2) operation because we can't
-		// sort the pattern in a useful way...
-
 		// Chop into terms
 		exvector ops;
 		ops.reserve(nops());
 		for (size_t i=0; i<nops(); i++)
 			ops.push_back(op(i));
 
-		// Now, for every term of the pattern, look for a matching term in
-		// the expression and remove the match
+		// Every term of the pattern (except the global wildcard) needs a
+		// term of the expression of its own
+		size_t num_pattern_terms = pattern.nops() - (has_global_wildcard ? 1 : 0);
+		if (num_pattern_terms > ops.size() || (!has_global_wildcard && num_pattern_terms < ops.size()))
+			return false;
+
+		// Terms of the pattern without wildcards only match equal terms and
+		// don't bind anything, so any matching term will do for them.  For
+		// the other terms, find the terms of the expression that they match
+		// on their own.
+		std::vector<bool> used(ops.size(), false);
+		exvector pats;
+		std::vector<std::vector<size_t> > cands;
 		for (size_t i=0; i<pattern.nops(); i++) {
-			ex p = pattern.op(i);
+			const ex & p = pattern.op(i);
 			if (has_global_wildcard && p.is_equal(global_wildcard))
 				continue;
-			exvector::iterator it = ops.begin(), itend = ops.end();
-			while (it != itend) {
-				if (it->match(p, tmp_repl)) {
-					ops.erase(it);
-					goto found;
-				}
-				++it;
+			if (!haswild(p)) {
+				size_t j = 0;
+				while (j < ops.size() && (used[j] || ops[j].gethash() != p.gethash() || !ops[j].match(p, tmp_repl)))
+					++j;
+				if (j == ops.size())
+					return false; // no match found
+				used[j] = true;
+				continue;
 			}
-			return false; // no match found
-found:		;
+			pats.push_back(p);
+			cands.push_back(std::vector<size_t>());
 		}
-
-		if (has_global_wildcard) {
-
-			// Assign all the remaining terms to the global wildcard (unless
-			// it has already been matched before, in which case the matches
-			// must be equal)
-			size_t num = ops.size();
-			std::auto_ptr<epvector> vp(new epvector);
-			vp->reserve(num);
-			for (size_t i=0; i<num; i++)
-				vp->push_back(split_ex_to_pair(ops[i]));
-			ex rest = thisexpairseq(vp, default_overall_coeff());
-			for (exmap::const_iterator it = tmp_repl.begin(); it != tmp_repl.end(); ++it) {
-				if (it->first.is_equal(global_wildcard)) {
-					if (rest.is_equal(it->second)) {
-						repl_lst = tmp_repl;
-						return true;
-					}
-					return false;
-				}
+		for (size_t i=0; i<pats.size(); i++) {
+			for (size_t j=0; j<ops.size(); j++) {
+				exmap repl = tmp_repl;
+				if (!used[j] && ops[j].match(pats[i], repl))
+					cands[i].push_back(j);
 			}
-			repl_lst = tmp_repl;
-			repl_lst[global_wildcard] = rest;
-			return true;
-
-		} else {
+			if (cands[i].empty())
+				return false;
+		}
 
-			// No global wildcard, then the match fails if there are any
-			// unmatched terms left
-			if (ops.empty()) {
-				repl_lst = tmp_repl;
-				return true;
-			}
+		// Every pattern term must be assigned a different candidate term,
+		// which is impossible if there is no complete matching in the
+		// bipartite graph of pattern terms and candidates
+		if (!has_complete_matching(cands, ops.size()))
 			return false;
+
+		// Now look for an assignment for which the wildcards are bound
+		// consistently, starting with the most constrained pattern terms
+		std::vector<size_t> order(pats.size());
+		for (size_t i=0; i<order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), fewer_candidates(cands));
+		exvector sorted_pats;
+		std::vector<std::vector<size_t> > sorted_cands;
+		sorted_pats.reserve(pats.size());
+		sorted_cands.reserve(pats.size());
+		for (size_t i=0; i<order.size(); i++) {
+			sorted_pats.push_back(pats[order[i]]);
+			sorted_cands.push_back(cands[order[i]]);
 		}
+
+		if (!match_terms(ops, used, sorted_pats, sorted_cands, 0, has_global_wildcard, global_wildcard, tmp_repl))
+			return false;
+		repl_lst.swap(tmp_repl);
+		return true;
 	}
 	return inherited::match(pattern, repl_lst);
 }
 
+/** Assign the terms pats[i], pats[i+1], ... of a pattern to different terms
+ *  of the expression that are not used yet, trying the candidates of each
+ *  term in turn and backing up if the remaining terms cannot be assigned.
+ *  The terms that are left over are matched by the global wildcard, if any.
+ *
+ *  @see expairseq::match() */
+bool expairseq::match_terms(const exvector & ops, std::vector<bool> & used,
+                            const exvector & pats, const std::vector<std::vector<size_t> > & cands,
+                            size_t i, bool has_global_wildcard, const ex & global_wildcard,
+                            exmap & repl_lst) const
+{
+	if (i == pats.size()) {
+		if (!has_global_wildcard)
+			return true;
+
+		// Assign all the remaining terms to the global wildcard (unless
+		// it has already been matched before, in which case the matches
+		// must be equal)
+		std::auto_ptr<epvector> vp(new epvector);
+		for (size_t j=0; j<ops.size(); j++)
+			if (!used[j])
+				vp->push_back(split_ex_to_pair(ops[j]));
+		ex rest = thisexpairseq(vp, default_overall_coeff());
+		exmap::const_iterator it = repl_lst.find(global_wildcard);
+		if (it != repl_lst.end())
+			return rest.is_equal(it->second);
+		repl_lst[global_wildcard] = rest;
+		return true;
+	}
+
+	for (std::vector<size_t>::const_iterator j = cands[i].begin(); j != cands[i].end(); ++j) {
+		if (used[*j])
+			continue;
+		exmap tmp_repl = repl_lst;
+		if (!ops[*j].match(pats[i], tmp_repl))
+			continue;
+		used[*j] = true;
+		if (match_terms(ops, used, pats, cands, i+1, has_global_wildcard, global_wildcard, tmp_repl)) {
+			repl_lst.swap(tmp_repl);
+			return true;
+		}
+		used[*j] = false;
+	}
+	return false;
+}
+
 ex expairseq::subs(const exmap & m, unsigned options) const
 {
 	std::auto_ptr<epvector> vp = subschildren(m, options);
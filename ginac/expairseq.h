@@ -158,6 +158,10 @@ protected:
 	std::auto_ptr<epvector> expandchildren(unsigned options) const;
 	std::auto_ptr<epvector> evalchildren(int level) const;
 	std::auto_ptr<epvector> subschildren(const exmap & m, unsigned options = 0) const;
+	bool match_terms(const exvector & ops, std::vector<bool> & used,
+	                 const exvector & pats, const std::vector<std::vector<size_t> > & cands,
+	                 size_t i, bool has_global_wildcard, const ex & global_wildcard,
+	                 exmap & repl_lst) const;
 	
 // member variables
 	
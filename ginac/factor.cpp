@@ -54,6 +54,8 @@
 
 #include "factor.h"
 
+#include "cancellation.h"
+#include "profiler.h"
 #include "ex.h"
 #include "numeric.h"
 #include "operators.h"
@@ -1247,6 +1249,7 @@ static inline cl_I calc_bound(const upoly& a, int maxdeg)
  */
 static void hensel_univar(const upoly& a_, unsigned int p, const umodpoly& u1_, const umodpoly& w1_, upoly& u, upoly& w)
 {
+	profile_scope prof(profiled_ops::hensel_univar);
 	upoly a = a_;
 	const cl_modint_ring& R = u1_[0].ring();
 
@@ -1282,6 +1285,7 @@ static void hensel_univar(const upoly& a_, unsigned int p, const umodpoly& u1_,
 
 	// step 4
 	while ( !e.empty() && modulus < maxmodulus ) {
+		cancellation::poll("factor");
 		upoly c = e / modulus;
 		phi = umodpoly_to_upoly(s) * c;
 		umodpoly sigmatilde;
@@ -1498,6 +1502,7 @@ struct ModFactors
  */
 static ex factor_univariate(const ex& poly, const ex& x, unsigned int& prime)
 {
+	profile_scope prof(profiled_ops::factor_univariate);
 	ex unit, cont, prim_ex;
 	poly.unitcontprim(x, unit, cont, prim_ex);
 	upoly prim;
@@ -1522,6 +1527,7 @@ static ex factor_univariate(const ex& poly, const ex& x, unsigned int& prime)
 	cl_I lc = lcoeff(prim)*i_cont;
 	upvec factors;
 	while ( trials < 2 ) {
+		cancellation::poll("factor");
 		umodpoly modpoly;
 		while ( true ) {
 			prime = next_prime(prime);
@@ -1565,6 +1571,7 @@ static ex factor_univariate(const ex& poly, const ex& x, unsigned int& prime)
 		const size_t n = tocheck.top().factors.size();
 		factor_partition part(tocheck.top().factors);
 		while ( true ) {
+			cancellation::poll("factor");
 			// call Hensel lifting
 			hensel_univar(tocheck.top().poly, prime, part.left(), part.right(), f1, f2);
 			if ( !f1.empty() ) {
@@ -1926,6 +1933,7 @@ static vector<ex> multivar_diophant(const vector<ex>& a_, const ex& x, const ex&
 
 		ex monomial = 1;
 		for ( size_t m=1; !e.is_zero() && e.has(xnu) && m<=d; ++m ) {
+			cancellation::poll("factor");
 			monomial *= (xnu - alphanu);
 			monomial = expand(monomial);
 			ex cm = e.diff(ex_to<symbol>(xnu), m).subs(xnu==alphanu) / factorial(m);
@@ -2007,6 +2015,7 @@ static vector<ex> multivar_diophant(const vector<ex>& a_, const ex& x, const ex&
 static ex hensel_multivar(const ex& a, const ex& x, const vector<EvalPoint>& I,
                           unsigned int p, const cl_I& l, const upvec& u, const vector<ex>& lcU)
 {
+	profile_scope prof(profiled_ops::hensel_multivar);
 	const size_t nu = I.size() + 1;
 	const cl_modint_ring R = find_modint_ring(expt_pos(cl_I(p),l));
 
@@ -2061,6 +2070,7 @@ static ex hensel_multivar(const ex& a, const ex& x, const vector<EvalPoint>& I,
 		int alphaj = I[j-2].evalpoint;
 		size_t deg = A[j-1].degree(xj);
 		for ( size_t k=1; k<=deg; ++k ) {
+			cancellation::poll("factor");
 			if ( !e.is_zero() ) {
 				monomial *= (xj - alphaj);
 				monomial = expand(monomial);
@@ -2257,6 +2267,7 @@ static ex factor_sqrfree(const ex& poly);
  */
 static ex factor_multivariate(const ex& poly, const exset& syms)
 {
+	profile_scope prof(profiled_ops::factor_multivariate);
 	exset::const_iterator s;
 	const ex& x = *syms.begin();
 
@@ -2294,6 +2305,7 @@ static ex factor_multivariate(const ex& poly, const exset& syms)
 
 		// try several evaluation points to reduce the number of factors
 		while ( trialcount < maxtrials ) {
+			cancellation::poll("factor");
 
 			// generate a set of valid evaluation points
 			generate_set(pp, vn, syms, ex_to<lst>(vnlst), modulus, u, a);
@@ -2539,6 +2551,7 @@ struct apply_factor_map : public map_function {
  */
 ex factor(const ex& poly, unsigned options)
 {
+	profile_scope prof(profiled_ops::factor);
 	// check arguments
 	if ( !poly.info(info_flags::polynomial) ) {
 		if ( options & factor_options::all ) {
@@ -80,7 +80,13 @@ public:
 		 *  themselves as step functions, if this option is not passed.  If
 		 *  it is passed and expansion at a point on a cut is performed, then
 		 *  the analytic continuation of the function is expanded. */
-		suppress_branchcut = 0x0001
+		suppress_branchcut = 0x0001,
+		/** Interpret the truncation order relative to the leading power of
+		 *  the expansion instead of as an absolute power.  With this option,
+		 *  if the expansion starts with x^k, series(x, n) is computed up to
+		 *  the order term O(x^(k+n)), no matter whether the expression has
+		 *  a pole or a zero at the expansion point. */
+		relative_order = 0x0002
 	};
 };
 
@@ -288,6 +294,18 @@ public:
 	};
 };
 
+/** Flags to control the behavior of normal(). If neither strategy is
+ *  selected, sums of many fractions are added with balanced_sum and short
+ *  ones with sequential_sum. */
+class normal_options {
+public:
+	enum {
+		sequential_sum = 0x0001, ///< add fractions one after another
+		balanced_sum   = 0x0002, ///< group fractions by denominator and add the groups pairwise
+		cache_gcd      = 0x0004  ///< cache GCDs for the duration of the call, see gcd_cache
+	};
+};
+
 /** Flags to control the polynomial factorization. */
 class factor_options {
 public:
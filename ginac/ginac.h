@@ -69,6 +69,11 @@
 #include "factor.h"
 
 #include "excompiler.h"
+#include "prepared_subs.h"
+#include "pattern_set.h"
+#include "evalf_cache.h"
+#include "cancellation.h"
+#include "profiler.h"
 
 #ifndef IN_GINAC
 #include "parser.h"
@@ -37,8 +37,10 @@
 #include "matrix.h"
 #include "inifcns.h"
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <sstream>
 #include <stdexcept>
 
@@ -1041,6 +1043,182 @@ bool hasindex(const ex &x, const ex &sym)
 	return false;
 }
 
+/** Upper limit for the number of renamings of the dummy indices of a term
+ *  that canonicalize_dummies() tries. */
+static const size_t max_dummy_renamings = 40320;
+
+/** Count how often the index symbol sym appears in x. */
+static size_t count_index(const ex & x, const ex & sym)
+{
+	if (is_a<idx>(x))
+		return x.op(0).is_equal(sym) ? 1 : 0;
+	size_t num = 0;
+	for (size_t i=0; i<x.nops(); ++i)
+		num += count_index(x.op(i), sym);
+	return num;
+}
+
+/** Split a term into a numeric coefficient and the rest. */
+static void split_coeff(const ex & term, ex & rest, ex & coeff)
+{
+	if (is_exactly_a<mul>(term) && is_exactly_a<numeric>(term.op(term.nops()-1))) {
+		coeff = term.op(term.nops()-1);
+		rest = term / coeff;
+	} else {
+		coeff = _ex1;
+		rest = term;
+	}
+}
+
+/** Properties of a dummy index in a term that do not depend on the names of
+ *  the dummy indices: the shapes of the factors it appears in, with the
+ *  number of times, and the same for the dummy indices it shares a factor
+ *  with. */
+typedef std::vector<std::pair<unsigned, size_t> > dummy_signature;
+typedef std::pair<dummy_signature, std::vector<dummy_signature> > dummy_class;
+
+/** Ordering of the dummy indices of a term by their classes. */
+class dummy_class_is_less {
+public:
+	dummy_class_is_less(const std::vector<dummy_class> & c) : classes(c) {}
+	bool operator() (size_t a, size_t b) const { return classes[a] < classes[b]; }
+private:
+	const std::vector<dummy_class> & classes;
+};
+
+/** Go to the next renaming, that is the next permutation of the symbols
+ *  within every class of dummy indices, whose boundaries are given by
+ *  "bounds".  Returns false after the last one. */
+static bool next_dummy_renaming(exvector & syms, const std::vector<size_t> & bounds)
+{
+	for (size_t c=0; c+1<bounds.size(); ++c)
+		if (std::next_permutation(syms.begin() + bounds[c], syms.begin() + bounds[c+1], ex_is_less()))
+			return true;
+	return false;
+}
+
+/** Bring a term of a sum into a canonical form with respect to the renaming
+ *  of its dummy indices, so that terms which only differ in the names of
+ *  the dummy indices get the same form.  The dummy indices are sorted into
+ *  classes by properties that do not depend on their names, and the classes
+ *  get the (sorted) dummy index symbols in turn.  Within each class, all
+ *  assignments are tried, and the least result (in the sense of ex_is_less)
+ *  with the numeric coefficient split off is the canonical form.
+ *
+ *  @param term Term to work on
+ *  @param dummy_syms Symbols of the dummy indices in the term
+ *  @param rest Canonical form (returned)
+ *  @param coeff Numeric coefficient of the canonical form in the term, zero
+ *    if a renaming shows that the term vanishes (returned)
+ *  @return false if there were too many renamings to try, then the term
+ *    is returned unchanged */
+static bool canonicalize_dummies(const ex & term, const exvector & dummy_syms, ex & rest, ex & coeff)
+{
+	split_coeff(term, rest, coeff);
+	const size_t num = dummy_syms.size();
+	if (num < 2)
+		return true;
+
+	// Take the factors of the term with all dummy indices replaced by the
+	// same symbol as their shapes
+	static const symbol placeholder;
+	exvector factors;
+	if (is_exactly_a<mul>(term) || is_exactly_a<ncmul>(term))
+		factors.insert(factors.end(), term.begin(), term.end());
+	else
+		factors.push_back(term);
+	exmap to_placeholder;
+	for (size_t d=0; d<num; ++d)
+		to_placeholder[dummy_syms[d]] = placeholder;
+	std::vector<unsigned> shapes;
+	shapes.reserve(factors.size());
+	for (exvector::const_iterator f = factors.begin(); f != factors.end(); ++f)
+		shapes.push_back(f->subs(to_placeholder, subs_options::no_pattern).gethash());
+
+	// Classify each dummy index by the shapes of the factors it appears in...
+	std::vector<dummy_signature> signatures(num);
+	std::vector<std::vector<size_t> > occurrences(num);
+	for (size_t d=0; d<num; ++d) {
+		for (size_t f=0; f<factors.size(); ++f) {
+			size_t count = count_index(factors[f], dummy_syms[d]);
+			if (count) {
+				signatures[d].push_back(std::make_pair(shapes[f], count));
+				occurrences[d].push_back(f);
+			}
+		}
+		std::sort(signatures[d].begin(), signatures[d].end());
+	}
+
+	// ...and by those of the dummy indices it shares a factor with
+	std::vector<dummy_class> classes(num);
+	for (size_t d=0; d<num; ++d) {
+		classes[d].first = signatures[d];
+		for (size_t e=0; e<num; ++e) {
+			if (e == d)
+				continue;
+			for (std::vector<size_t>::const_iterator f = occurrences[e].begin(); f != occurrences[e].end(); ++f)
+				if (std::find(occurrences[d].begin(), occurrences[d].end(), *f) != occurrences[d].end()) {
+					classes[d].second.push_back(signatures[e]);
+					break;
+				}
+		}
+		std::sort(classes[d].second.begin(), classes[d].second.end());
+	}
+
+	// Order the dummy indices by class, and count the renamings
+	std::vector<size_t> order(num);
+	for (size_t d=0; d<num; ++d)
+		order[d] = d;
+	std::sort(order.begin(), order.end(), dummy_class_is_less(classes));
+	exvector from;
+	from.reserve(num);
+	std::vector<size_t> bounds(1, 0);
+	size_t num_renamings = 1;
+	for (size_t d=0; d<num; ++d) {
+		if (d > 0 && classes[order[d-1]] < classes[order[d]])
+			bounds.push_back(d);
+		from.push_back(dummy_syms[order[d]]);
+		num_renamings *= d + 1 - bounds.back();
+		if (num_renamings > max_dummy_renamings)
+			return false;
+	}
+	bounds.push_back(num);
+
+	// Try all renamings and keep the least result
+	const lst from_lst(from.begin(), from.end());
+	exvector to = dummy_syms;
+	std::sort(to.begin(), to.end(), ex_is_less());
+	bool first = true;
+	do {
+		ex renamed_rest, renamed_coeff;
+		split_coeff(term.subs(from_lst, lst(to.begin(), to.end()), subs_options::no_pattern), renamed_rest, renamed_coeff);
+		int cmpval = first ? -1 : renamed_rest.compare(rest);
+		first = false;
+		if (cmpval < 0) {
+			rest = renamed_rest;
+			coeff = renamed_coeff;
+		} else if (cmpval == 0 && !renamed_coeff.is_equal(coeff)) {
+
+			// The term equals a multiple of itself, like
+			// A.i.j*B.i*B.j with antisymmetric A
+			coeff = _ex0;
+			return true;
+		}
+	} while (next_dummy_renaming(to, bounds));
+	return true;
+}
+
+/** This structure stores the terms of a sum that have the same canonical
+ *  form with respect to the renaming of dummy indices. */
+class termgroup {
+public:
+	termgroup(const ex & orig_, const ex & coeff_) : orig(orig_), orig_coeff(coeff_), coeff(coeff_) {}
+
+	ex orig;       /**< first term of the group */
+	ex orig_coeff; /**< coefficient of the canonical form in the first term */
+	ex coeff;      /**< sum of the coefficients of the canonical form */
+};
+
 /** Simplify indexed expression, return list of free indices. */
 ex simplify_indexed(const ex & e, exvector & free_indices, exvector & dummy_indices, const scalar_products & sp)
 {
@@ -1079,7 +1257,8 @@ ex simplify_indexed(const ex & e, exvector & free_indices, exvector & dummy_indi
 	// free indices in each term
 	if (is_exactly_a<add>(e_expanded)) {
 		bool first = true;
-		ex sum;
+		exvector simplified_terms;
+		simplified_terms.reserve(e_expanded.nops());
 		free_indices.clear();
 
 		for (size_t i=0; i<e_expanded.nops(); i++) {
@@ -1088,7 +1267,7 @@ ex simplify_indexed(const ex & e, exvector & free_indices, exvector & dummy_indi
 			if (!term.is_zero()) {
 				if (first) {
 					free_indices = free_indices_of_term;
-					sum = term;
+					simplified_terms.push_back(term);
 					first = false;
 				} else {
 					if (!indices_consistent(free_indices, free_indices_of_term)) {
@@ -1097,14 +1276,20 @@ ex simplify_indexed(const ex & e, exvector & free_indices, exvector & dummy_indi
 						s << exprseq(free_indices) << " vs. " << exprseq(free_indices_of_term);
 						throw (std::runtime_error(s.str()));
 					}
-					if (is_a<indexed>(sum) && is_a<indexed>(term))
+					ex & sum = simplified_terms.front();
+					if (simplified_terms.size() == 1 && is_a<indexed>(sum) && is_a<indexed>(term))
 						sum = ex_to<basic>(sum.op(0)).add_indexed(sum, term);
 					else
-						sum += term;
+						simplified_terms.push_back(term);
 				}
 			}
 		}
 
+		// Build the sum at once, adding up the terms one by one takes
+		// quadratic time
+		ex sum = simplified_terms.size() == 1 ? simplified_terms.front()
+		       : (new add(simplified_terms))->setflag(status_flags::dynallocated);
+
 		// If the sum turns out to be zero, we are finished
 		if (sum.is_zero()) {
 			free_indices.clear();
@@ -1116,6 +1301,49 @@ ex simplify_indexed(const ex & e, exvector & free_indices, exvector & dummy_indi
 		if (num_terms_orig < 2 || dummy_indices.size() < 2)
 			return sum;
 
+		// Merge terms that only differ in the names of their dummy indices
+		bool all_canonical = true;
+		std::vector<termgroup> groups;
+		std::map<ex, size_t, ex_is_less> group_of_form;
+		for (size_t i=0; i<sum.nops(); i++) {
+			const ex & term = sum.op(i);
+			exvector dummy_syms_of_term;
+			dummy_syms_of_term.reserve(dummy_indices.size());
+			for (exvector::const_iterator j=dummy_indices.begin(); j!=dummy_indices.end(); ++j)
+				if (hasindex(term, j->op(0)) && std::find_if(dummy_syms_of_term.begin(), dummy_syms_of_term.end(), bind2nd(ex_is_equal(), j->op(0))) == dummy_syms_of_term.end())
+					dummy_syms_of_term.push_back(j->op(0));
+			ex form, coeff;
+			if (!canonicalize_dummies(term, dummy_syms_of_term, form, coeff))
+				all_canonical = false;
+			if (coeff.is_zero())
+				continue;
+			std::map<ex, size_t, ex_is_less>::const_iterator found = group_of_form.find(form);
+			if (found == group_of_form.end()) {
+				group_of_form[form] = groups.size();
+				groups.push_back(termgroup(term, coeff));
+			} else
+				groups[found->second].coeff += coeff;
+		}
+		exvector merged;
+		merged.reserve(groups.size());
+		for (std::vector<termgroup>::const_iterator i=groups.begin(); i!=groups.end(); ++i) {
+			if (i->coeff.is_zero())
+				continue;
+			if (i->coeff.is_equal(i->orig_coeff))
+				merged.push_back(i->orig);
+			else
+				merged.push_back(i->orig * (i->coeff / i->orig_coeff));
+		}
+		sum = (new add(merged))->setflag(status_flags::dynallocated);
+		if (sum.is_zero())
+			free_indices.clear();
+
+		// Unless some terms had too many dummy indices for that, the sum
+		// is now free of terms that are equal after renaming, otherwise
+		// fall back to comparing the symmetrized terms
+		if (all_canonical || !is_exactly_a<add>(sum))
+			return sum;
+
 		// Chop the sum into terms and symmetrize each one over the dummy
 		// indices
 		std::vector<terminfo> terms;
@@ -1275,6 +1503,32 @@ ex ex::simplify_indexed(const scalar_products & sp, unsigned options) const
 	return GiNaC::simplify_indexed(*this, free_indices, dummy_indices, sp);
 }
 
+exvector simplify_indexed(const exvector & v, const scalar_products & sp)
+{
+	exvector result, dummy_indices;
+	result.reserve(v.size());
+	for (exvector::const_iterator i = v.begin(); i != v.end(); ++i) {
+
+		// Only reuse the dummy indices of the previous expressions whose
+		// names do not occur in this one, otherwise they could capture
+		// its free indices
+		exvector dummy_indices_of_item;
+		for (exvector::const_iterator j = dummy_indices.begin(); j != dummy_indices.end(); ++j)
+			if (!hasindex(*i, j->op(0)))
+				dummy_indices_of_item.push_back(*j);
+		const size_t reused = dummy_indices_of_item.size();
+
+		exvector free_indices;
+		result.push_back(simplify_indexed(*i, free_indices, dummy_indices_of_item, sp));
+
+		// Remember the new dummy indices for the following expressions
+		for (exvector::const_iterator j = dummy_indices_of_item.begin() + reused; j != dummy_indices_of_item.end(); ++j)
+			if (find_if(dummy_indices.begin(), dummy_indices.end(), bind2nd(idx_is_equal_ignore_dim(), *j)) == dummy_indices.end())
+				dummy_indices.push_back(*j);
+	}
+	return result;
+}
+
 /** Symmetrize expression over its free indices. */
 ex ex::symmetrize() const
 {
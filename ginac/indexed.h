@@ -251,6 +251,19 @@ protected:
 
 // utility functions
 
+/** Simplify a list of expressions with the same scalar products, as
+ *  simplify_indexed(sp) does for each one, but with the dummy indices named
+ *  consistently across the whole list, so that the results can be combined
+ *  without renaming.  A dummy index name of an earlier expression is not
+ *  reused in an expression in which that name already occurs, so each
+ *  result is the same as simplifying its expression alone, up to the
+ *  names of the dummy indices.
+ *
+ *  @param v Expressions to simplify
+ *  @param sp Scalar products to be replaced automatically
+ *  @return simplified expressions, in the same order */
+exvector simplify_indexed(const exvector & v, const scalar_products & sp);
+
 /** Returns all dummy indices from the expression */
 exvector get_all_dummy_indices(const ex & e);
 
@@ -210,6 +210,22 @@ inline bool is_order_function(const ex & e)
  */
 ex convert_H_to_Li(const ex& parameterlst, const ex& arg);
 
+/** Numerically evaluates many expressions containing multiple polylogarithms
+ *  together.  Values of G functions (which are also used for evaluating Li
+ *  and H with more than one index) that are needed for several expressions,
+ *  for example by G functions with a common prefix of parameters, are
+ *  computed only once.
+ */
+exvector G_evalf_batch(const exvector& exprs);
+
+/** Precomputes the lookup tables used for the numerical evaluation of
+ *  polylogarithms (Li, S, H) up to the given weight.  The tables for Li are
+ *  exact, those for S depend on Digits and are kept for several precisions.
+ *  Calling this at startup avoids the delay at the first evaluation.  Each
+ *  thread has its own tables, so this fills those of the calling thread.
+ */
+void prepare_polylog_tables(int weight);
+
 } // namespace GiNaC
 
 #endif // ndef GINAC_INIFCNS_H
@@ -67,12 +67,14 @@
 #include "inifcns.h"
 
 #include "add.h"
+#include "compiler.h"
 #include "constant.h"
 #include "lst.h"
 #include "mul.h"
 #include "numeric.h"
 #include "operators.h"
 #include "power.h"
+#include "prepared_subs.h"
 #include "pseries.h"
 #include "relational.h"
 #include "symbol.h"
@@ -80,6 +82,10 @@
 #include "wildcard.h"
 
 #include <cln/cln.h>
+#include <complex>
+#include <limits>
+#include <list>
+#include <map>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -100,13 +106,84 @@ namespace GiNaC {
 namespace {
 
 
-// lookup table for factors built from Bernoulli numbers
-// see fill_Xn()
-std::vector<std::vector<cln::cl_N> > Xn;
+// A double holds std::numeric_limits<double>::digits10 (15) decimal digits
+// exactly, and the summations lose some more in rounding.  With at most one
+// digit less requested, the summations are done with hardware doubles
+// instead of CLN numbers, which gives the requested precision in a fraction
+// of the time.  If a sum overflows, the CLN summation is used after all.
+typedef std::complex<double> cdouble;
+
+
+inline bool use_double_sums()
+{
+	return Digits < std::numeric_limits<double>::digits10;
+}
+
+
+cdouble to_cdouble(const cln::cl_N& x)
+{
+	return cdouble(cln::double_approx(cln::realpart(x)), cln::double_approx(cln::imagpart(x)));
+}
+
+
+std::vector<double> to_double(const std::vector<cln::cl_N>& v)
+{
+	std::vector<double> d(v.size());
+	for (std::size_t i = 0; i < v.size(); ++i)
+		d[i] = cln::double_approx(cln::realpart(v[i]));
+	return d;
+}
+
+
+cln::cl_N from_cdouble(const cdouble& x)
+{
+	if (x.imag() == 0)
+		return cln::cl_DF(x.real());
+	return cln::complex(cln::cl_DF(x.real()), cln::cl_DF(x.imag()));
+}
+
+
+inline bool is_finite(const cdouble& x)
+{
+	// inf-inf and NaN-NaN are NaN, which is not equal to zero
+	return x.real() - x.real() == 0 && x.imag() - x.imag() == 0;
+}
+
+
+// termination condition of the summations: the sum is still changing
+// (and has not run into NaN, which is never equal to anything)
+inline bool changing(const cdouble& res, const cdouble& resbuf)
+{
+	return res != resbuf && res == res;
+}
+
+
+// returns the calling thread's instance of T, created on first use
+// The lookup tables below are kept per thread, so that polylogarithms can
+// be evaluated in several threads without locking.  The instances are not
+// freed when a thread ends.
+template <class T> T& per_thread()
+{
+	static GINAC_THREAD_LOCAL T* instance = 0;
+	if (!instance)
+		instance = new T;
+	return *instance;
+}
+
+
 // initial size of Xn that should suffice for 32bit machines (must be even)
 const int xninitsizestep = 26;
-int xninitsize = xninitsizestep;
-int xnsize = 0;
+
+// lookup table for factors built from Bernoulli numbers
+// see fill_Xn()
+struct Xn_table
+{
+	Xn_table() : xninitsize(xninitsizestep), xnsize(0) {}
+	std::vector<std::vector<cln::cl_N> > Xn;
+	std::vector<std::vector<double> > Xnd; // Xn converted to doubles, see Xn_double()
+	int xninitsize; // length of all Xn[i] (Xn[0] has half of it)
+	int xnsize; // number of Xn[]
+};
 
 
 // This function calculates the X_n. The X_n are needed for speed up of classical polylogarithms.
@@ -121,6 +198,9 @@ int xnsize = 0;
 // The second index in Xn corresponds to the index from the actual sum.
 void fill_Xn(int n)
 {
+	std::vector<std::vector<cln::cl_N> >& Xn = per_thread<Xn_table>().Xn;
+	const int xninitsize = per_thread<Xn_table>().xninitsize;
+
 	if (n>1) {
 		// calculate X_2 and higher (corresponding to Li_4 and higher)
 		std::vector<cln::cl_N> buf(xninitsize);
@@ -181,12 +261,14 @@ void fill_Xn(int n)
 		Xn.push_back(buf);
 	}
 
-	xnsize++;
+	per_thread<Xn_table>().xnsize++;
 }
 
 // doubles the number of entries in each Xn[]
 void double_Xn()
 {
+	std::vector<std::vector<cln::cl_N> >& Xn = per_thread<Xn_table>().Xn;
+	int& xninitsize = per_thread<Xn_table>().xninitsize;
 	const int pos0 = xninitsize / 2;
 	// X_0
 	for (int i=1; i<=xninitsizestep/2; ++i) {
@@ -231,9 +313,57 @@ void double_Xn()
 }
 
 
+// returns Xn[n] as doubles
+const std::vector<double>& Xn_double(int n)
+{
+	const std::vector<std::vector<cln::cl_N> >& Xn = per_thread<Xn_table>().Xn;
+	std::vector<std::vector<double> >& Xnd = per_thread<Xn_table>().Xnd;
+	if (Xnd.size() < Xn.size())
+		Xnd.resize(Xn.size());
+	std::vector<double>& d = Xnd[n];
+	for (std::size_t i = d.size(); i < Xn[n].size(); ++i)
+		d.push_back(cln::double_approx(cln::realpart(Xn[n][i])));
+	return d;
+}
+
+
+// makes sure that Xn[0] ... Xn[n-2] exist
+void prepare_Xn(int n)
+{
+	for (int i=per_thread<Xn_table>().xnsize; i<n-1; i++) {
+		fill_Xn(i);
+	}
+}
+
+
+// calculates Li(2,x) without Xn, in double precision
+cdouble Li2_do_sum_double(const cdouble& x)
+{
+	cdouble res = x;
+	cdouble resbuf;
+	cdouble num = x;
+	double den = 1; // n^2 = 1
+	unsigned i = 3;
+	do {
+		resbuf = res;
+		num = num * x;
+		den = den + i;  // n^2 = 4, 9, 16, ...
+		i += 2;
+		res = res + num / den;
+	} while (changing(res, resbuf));
+	return res;
+}
+
+
 // calculates Li(2,x) without Xn
 cln::cl_N Li2_do_sum(const cln::cl_N& x)
 {
+	if (use_double_sums()) {
+		const cdouble res = Li2_do_sum_double(to_cdouble(x));
+		if (is_finite(res))
+			return from_cdouble(res);
+	}
+
 	cln::cl_N res = x;
 	cln::cl_N resbuf;
 	cln::cl_N num = x * cln::cl_float(1, cln::float_format(Digits));
@@ -250,9 +380,40 @@ cln::cl_N Li2_do_sum(const cln::cl_N& x)
 }
 
 
+// calculates Li(2,x) with Xn, in double precision
+cdouble Li2_do_sum_Xn_double(const cdouble& x)
+{
+	const std::vector<double>* X = &Xn_double(0);
+	cdouble u = -std::log(1.0-x);
+	cdouble factor = u;
+	cdouble uu = u * u;
+	cdouble res = u - uu/4.0;
+	cdouble resbuf;
+	unsigned i = 1;
+	do {
+		resbuf = res;
+		factor = factor * uu / double(2*i * (2*i+1));
+		res = res + (*X)[i-1] * factor;
+		i++;
+		if (i-1 == X->size()) {
+			double_Xn();
+			X = &Xn_double(0);
+		}
+	} while (changing(res, resbuf));
+	return res;
+}
+
+
 // calculates Li(2,x) with Xn
 cln::cl_N Li2_do_sum_Xn(const cln::cl_N& x)
 {
+	if (use_double_sums()) {
+		const cdouble res = Li2_do_sum_Xn_double(to_cdouble(x));
+		if (is_finite(res))
+			return from_cdouble(res);
+	}
+
+	const std::vector<std::vector<cln::cl_N> >& Xn = per_thread<Xn_table>().Xn;
 	std::vector<cln::cl_N>::const_iterator it = Xn[0].begin();
 	std::vector<cln::cl_N>::const_iterator xend = Xn[0].end();
 	cln::cl_N u = -cln::log(1-x);
@@ -276,9 +437,32 @@ cln::cl_N Li2_do_sum_Xn(const cln::cl_N& x)
 }
 
 
+// calculates Li(n,x), n>2 without Xn, in double precision
+cdouble Lin_do_sum_double(int n, const cdouble& x)
+{
+	cdouble factor = x;
+	cdouble res = x;
+	cdouble resbuf;
+	int i=2;
+	do {
+		resbuf = res;
+		factor = factor * x;
+		res = res + factor / std::pow(double(i), n);
+		i++;
+	} while (changing(res, resbuf));
+	return res;
+}
+
+
 // calculates Li(n,x), n>2 without Xn
 cln::cl_N Lin_do_sum(int n, const cln::cl_N& x)
 {
+	if (use_double_sums()) {
+		const cdouble res = Lin_do_sum_double(n, to_cdouble(x));
+		if (is_finite(res))
+			return from_cdouble(res);
+	}
+
 	cln::cl_N factor = x * cln::cl_float(1, cln::float_format(Digits));
 	cln::cl_N res = x;
 	cln::cl_N resbuf;
@@ -293,9 +477,39 @@ cln::cl_N Lin_do_sum(int n, const cln::cl_N& x)
 }
 
 
+// calculates Li(n,x), n>2 with Xn, in double precision
+cdouble Lin_do_sum_Xn_double(int n, const cdouble& x)
+{
+	const std::vector<double>* X = &Xn_double(n-2);
+	cdouble u = -std::log(1.0-x);
+	cdouble factor = u;
+	cdouble res = u;
+	cdouble resbuf;
+	unsigned i=2;
+	do {
+		resbuf = res;
+		factor = factor * u / double(i);
+		res = res + (*X)[i-2] * factor;
+		i++;
+		if (i-2 == X->size()) {
+			double_Xn();
+			X = &Xn_double(n-2);
+		}
+	} while (changing(res, resbuf));
+	return res;
+}
+
+
 // calculates Li(n,x), n>2 with Xn
 cln::cl_N Lin_do_sum_Xn(int n, const cln::cl_N& x)
 {
+	if (use_double_sums()) {
+		const cdouble res = Lin_do_sum_Xn_double(n, to_cdouble(x));
+		if (is_finite(res))
+			return from_cdouble(res);
+	}
+
+	const std::vector<std::vector<cln::cl_N> >& Xn = per_thread<Xn_table>().Xn;
 	std::vector<cln::cl_N>::const_iterator it = Xn[n-2].begin();
 	std::vector<cln::cl_N>::const_iterator xend = Xn[n-2].end();
 	cln::cl_N u = -cln::log(1-x);
@@ -328,9 +542,7 @@ cln::cl_N Li_projection(int n, const cln::cl_N& x, const cln::float_format_t& pr
 	// treat n=2 as special case
 	if (n == 2) {
 		// check if precalculated X0 exists
-		if (xnsize == 0) {
-			fill_Xn(0);
-		}
+		prepare_Xn(2);
 
 		if (cln::realpart(x) < 0.5) {
 			// choose the faster algorithm
@@ -357,11 +569,7 @@ cln::cl_N Li_projection(int n, const cln::cl_N& x, const cln::float_format_t& pr
 		}
 	} else {
 		// check if precalculated Xn exist
-		if (n > xnsize+1) {
-			for (int i=xnsize; i<n-1; i++) {
-				fill_Xn(i);
-			}
-		}
+		prepare_Xn(n);
 
 		if (cln::realpart(x) < 0.5) {
 			// choose the faster algorithm
@@ -471,6 +679,35 @@ namespace {
 
 
 // performs the actual series summation for multiple polylogarithms
+// multipleLi_do_sum in double precision
+cdouble multipleLi_do_sum_double(const std::vector<int>& s, const std::vector<cdouble>& x)
+{
+	const int j = s.size();
+	bool flag_accidental_zero = false;
+
+	std::vector<cdouble> t(j);
+
+	cdouble t0buf;
+	int q = 0;
+	do {
+		t0buf = t[0];
+		q++;
+		t[j-1] = t[j-1] + std::pow(x[j-1], q) / std::pow(double(q), s[j-1]);
+		for (int k=j-2; k>=0; k--) {
+			t[k] = t[k] + t[k+1] * std::pow(x[k], q+j-1-k) / std::pow(double(q+j-1-k), s[k]);
+		}
+		q++;
+		t[j-1] = t[j-1] + std::pow(x[j-1], q) / std::pow(double(q), s[j-1]);
+		for (int k=j-2; k>=0; k--) {
+			flag_accidental_zero = (t[k+1] == 0.0);
+			t[k] = t[k] + t[k+1] * std::pow(x[k], q+j-1-k) / std::pow(double(q+j-1-k), s[k]);
+		}
+	} while ( changing(t[0], t0buf) || (t[0] == 0.0) || flag_accidental_zero );
+
+	return t[0];
+}
+
+
 cln::cl_N multipleLi_do_sum(const std::vector<int>& s, const std::vector<cln::cl_N>& x)
 {
 	// ensure all x <> 0.
@@ -478,6 +715,16 @@ cln::cl_N multipleLi_do_sum(const std::vector<int>& s, const std::vector<cln::cl
 		if ( *it == 0 ) return cln::cl_float(0, cln::float_format(Digits));
 	}
 
+	if (use_double_sums()) {
+		std::vector<cdouble> xd;
+		xd.reserve(x.size());
+		for (std::vector<cln::cl_N>::const_iterator it = x.begin(); it != x.end(); ++it)
+			xd.push_back(to_cdouble(*it));
+		const cdouble res = multipleLi_do_sum_double(s, xd);
+		if (is_finite(res))
+			return from_cdouble(res);
+	}
+
 	const int j = s.size();
 	bool flag_accidental_zero = false;
 
@@ -990,6 +1237,65 @@ static cln::cl_N
 G_numeric(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
 	  const cln::cl_N& y);
 
+
+// arguments of G_numeric, used as key for remembering its values
+struct G_numeric_args
+{
+	std::vector<cln::cl_N> x;
+	std::vector<int> s;
+	cln::cl_N y;
+	long digits;
+};
+
+
+int compare_cl_N(const cln::cl_N& a, const cln::cl_N& b)
+{
+	const int c = cln::compare(cln::realpart(a), cln::realpart(b));
+	if (c != 0)
+		return c;
+	return cln::compare(cln::imagpart(a), cln::imagpart(b));
+}
+
+
+struct G_numeric_args_less
+{
+	bool operator()(const G_numeric_args& a, const G_numeric_args& b) const
+	{
+		if (a.digits != b.digits)
+			return a.digits < b.digits;
+		if (a.s != b.s)
+			return a.s < b.s;
+		if (a.x.size() != b.x.size())
+			return a.x.size() < b.x.size();
+		for (std::size_t i = 0; i < a.x.size(); ++i) {
+			const int c = compare_cl_N(a.x[i], b.x[i]);
+			if (c != 0)
+				return c < 0;
+		}
+		return compare_cl_N(a.y, b.y) < 0;
+	}
+};
+
+
+// Values of G_numeric computed since the outermost G_numeric_scope was
+// entered.  The Hoelder convolution and the convergence transformation
+// evaluate many G functions with the same arguments, and so do G
+// functions sharing a common prefix of their parameters.
+typedef std::map<G_numeric_args, cln::cl_N, G_numeric_args_less> G_numeric_memo_t;
+G_numeric_memo_t G_numeric_memo;
+int G_numeric_depth = 0;
+
+
+struct G_numeric_scope
+{
+	G_numeric_scope() { ++G_numeric_depth; }
+	~G_numeric_scope()
+	{
+		if (--G_numeric_depth == 0)
+			G_numeric_memo.clear();
+	}
+};
+
 // do acceleration transformation (hoelder convolution [BBB])
 // the parameter x, s and y must only contain numerics
 static cln::cl_N
@@ -1043,6 +1349,16 @@ G_do_hoelder(std::vector<cln::cl_N> x, /* yes, it's passed by value */
 	return result;
 }
 
+// The result of G_transform only depends on the order of the absolute
+// values of the arguments of G (and on which of them are equal), not on
+// the values themselves.  The transformed expressions are remembered for
+// each such pattern, prepared for substituting the actual values.
+typedef std::pair<Gparameter, std::vector<int> > G_trafo_pattern;
+typedef std::map<G_trafo_pattern, prepared_subs> G_trafo_cache_t;
+G_trafo_cache_t G_trafo_cache;
+const std::size_t G_trafo_cache_max_size = 1000;
+
+
 // convergence transformation, used for numerical evaluation of G function.
 // the parameter x, s and y must only contain numerics
 static cln::cl_N
@@ -1062,40 +1378,24 @@ G_do_trafo(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
 	// include upper limit (scale)
 	sortmap.insert(std::make_pair(abs(y), x.size()));
 
-	// generate missing dummy-symbols
-	int i = 1;
-	// holding dummy-symbols for the G/Li transformations
-	exvector gsyms;
-	gsyms.push_back(symbol("GSYMS_ERROR"));
+	// number the distinct values, equal values share one dummy-symbol
+	// (symbol 0 is reserved for errors)
+	std::vector<int> symnum(1, 0);
+	exvector values;
 	cln::cl_N lastentry(0);
 	for (sortmap_t::const_iterator it = sortmap.begin(); it != sortmap.end(); ++it) {
-		if (it != sortmap.begin()) {
-			if (it->second < x.size()) {
-				if (x[it->second] == lastentry) {
-					gsyms.push_back(gsyms.back());
-					continue;
-				}
-			} else {
-				if (y == lastentry) {
-					gsyms.push_back(gsyms.back());
-					continue;
-				}
-			}
-		}
-		std::ostringstream os;
-		os << "a" << i;
-		gsyms.push_back(symbol(os.str()));
-		++i;
-		if (it->second < x.size()) {
-			lastentry = x[it->second];
-		} else {
-			lastentry = y;
+		const cln::cl_N& entry = it->second < x.size() ? x[it->second] : y;
+		if (it != sortmap.begin() && entry == lastentry) {
+			symnum.push_back(symnum.back());
+			continue;
 		}
+		values.push_back(numeric(entry));
+		symnum.push_back(values.size());
+		lastentry = entry;
 	}
 
-	// fill position data according to sorted indices and prepare substitution list
+	// fill position data according to sorted indices
 	Gparameter a(x.size());
-	exmap subslst;
 	std::size_t pos = 1;
 	int scale = pos;
 	for (sortmap_t::const_iterator it = sortmap.begin(); it != sortmap.end(); ++it) {
@@ -1105,20 +1405,44 @@ G_do_trafo(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
 			} else {
 				a[it->second] = -int(pos);
 			}
-			subslst[gsyms[pos]] = numeric(x[it->second]);
 		} else {
 			scale = pos;
-			subslst[gsyms[pos]] = numeric(y);
 		}
 		++pos;
 	}
 
-	// do transformation
-	Gparameter pendint;
-	ex result = G_transform(pendint, a, scale, gsyms);
-	// replace dummy symbols with their values
-	result = result.eval().expand();
-	result = result.subs(subslst).evalf();
+	G_trafo_pattern pattern(a, symnum);
+	pattern.second.push_back(scale);
+	G_trafo_cache_t::iterator cached = G_trafo_cache.find(pattern);
+	if (cached == G_trafo_cache.end()) {
+		// generate dummy-symbols for the G/Li transformations
+		exvector syms;
+		for (std::size_t i = 1; i <= values.size(); ++i) {
+			std::ostringstream os;
+			os << "a" << i;
+			syms.push_back(symbol(os.str()));
+		}
+		exvector gsyms;
+		gsyms.push_back(symbol("GSYMS_ERROR"));
+		for (std::size_t i = 1; i < symnum.size(); ++i)
+			gsyms.push_back(syms[symnum[i] - 1]);
+
+		// do transformation
+		Gparameter pendint;
+		ex result = G_transform(pendint, a, scale, gsyms);
+		result = result.eval().expand();
+
+		if (G_trafo_cache.size() >= G_trafo_cache_max_size)
+			G_trafo_cache.clear();
+		cached = G_trafo_cache.insert(std::make_pair(pattern,
+			prepared_subs(result, lst(syms.begin(), syms.end())))).first;
+	}
+
+	// replace dummy symbols with their values; the values are substituted
+	// exactly before evaluating, as the transformed expression contains
+	// powers of logarithms of negative numbers whose exponents must not
+	// become floating point numbers
+	ex result = cached->second.subs(values).evalf();
 	if (!is_a<numeric>(result))
 		throw std::logic_error("G_do_trafo: G_transform returned non-numeric result");
 	
@@ -1126,11 +1450,12 @@ G_do_trafo(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
 	return ret;
 }
 
+
 // handles the transformations and the numerical evaluation of G
 // the parameter x, s and y must only contain numerics
 static cln::cl_N
-G_numeric(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
-	  const cln::cl_N& y)
+G_do_numeric(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
+	     const cln::cl_N& y)
 {
 	// check for convergence and necessary accelerations
 	bool need_trafo = false;
@@ -1189,6 +1514,27 @@ G_numeric(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
 }
 
 
+// G_do_numeric with remembering of the values within a G_numeric_scope
+static cln::cl_N
+G_numeric(const std::vector<cln::cl_N>& x, const std::vector<int>& s,
+	  const cln::cl_N& y)
+{
+	G_numeric_scope scope;
+	G_numeric_args args;
+	args.x = x;
+	args.s = s;
+	args.y = y;
+	args.digits = Digits;
+	G_numeric_memo_t::const_iterator it = G_numeric_memo.find(args);
+	if (it != G_numeric_memo.end())
+		return it->second;
+
+	const cln::cl_N result = G_do_numeric(x, s, y);
+	G_numeric_memo.insert(std::make_pair(args, result));
+	return result;
+}
+
+
 ex mLi_numeric(const lst& m, const lst& x)
 {
 	// let G_numeric do the transformation
@@ -1326,6 +1672,7 @@ unsigned G2_SERIAL::serial = function::register_new(function_options("G", 2).
                                 evalf_func(G2_evalf).
                                 eval_func(G2_eval).
                                 do_not_evalf_params().
+                                persistent_evalf().
                                 overloaded(2));
 //TODO
 //                                derivative_func(G2_deriv).
@@ -1472,12 +1819,25 @@ unsigned G3_SERIAL::serial = function::register_new(function_options("G", 3).
                                 evalf_func(G3_evalf).
                                 eval_func(G3_eval).
                                 do_not_evalf_params().
+                                persistent_evalf().
                                 overloaded(2));
 //TODO
 //                                derivative_func(G3_deriv).
 //                                print_func<print_latex>(G3_print_latex).
 
 
+// evaluates all expressions within one G_numeric_scope
+exvector G_evalf_batch(const exvector& exprs)
+{
+	G_numeric_scope scope;
+	exvector result;
+	result.reserve(exprs.size());
+	for (exvector::const_iterator it = exprs.begin(); it != exprs.end(); ++it)
+		result.push_back(it->evalf());
+	return result;
+}
+
+
 //////////////////////////////////////////////////////////////////////
 //
 // Classical polylogarithm and multiple polylogarithm  Li(m,x)
@@ -1742,7 +2102,8 @@ REGISTER_FUNCTION(Li,
                   series_func(Li_series).
                   derivative_func(Li_deriv).
                   print_func<print_latex>(Li_print_latex).
-                  do_not_evalf_params());
+                  do_not_evalf_params().
+                  persistent_evalf());
 
 
 //////////////////////////////////////////////////////////////////////
@@ -1760,9 +2121,36 @@ namespace {
 
 // lookup table for special Euler-Zagier-Sums (used for S_n,p(x))
 // see fill_Yn()
-std::vector<std::vector<cln::cl_N> > Yn;
-int ynsize = 0; // number of Yn[]
-int ynlength = 100; // initial length of all Yn[i]
+// The entries are floating point numbers, so each precision needs its own
+// table.  The tables for the last few precisions used are kept, the most
+// recently used one first, separately for each thread.
+struct Yn_table
+{
+	Yn_table(const cln::float_format_t& prec_) : prec(prec_), ynsize(0), ynlength(100) {}
+	cln::float_format_t prec;
+	std::vector<std::vector<cln::cl_N> > Yn;
+	int ynsize; // number of Yn[]
+	int ynlength; // length of all Yn[i], initially 100
+};
+const std::size_t Yn_max_tables = 4;
+
+
+// returns the table for the given precision, creating it if necessary
+Yn_table& get_Yn_table(const cln::float_format_t& prec)
+{
+	std::list<Yn_table>& Yn_tables = per_thread<std::list<Yn_table> >();
+	std::list<Yn_table>::iterator it = Yn_tables.begin();
+	while (it != Yn_tables.end() && it->prec != prec)
+		++it;
+	if (it == Yn_tables.end()) {
+		if (Yn_tables.size() >= Yn_max_tables)
+			Yn_tables.pop_back();
+		Yn_tables.push_front(Yn_table(prec));
+	} else if (it != Yn_tables.begin()) {
+		Yn_tables.splice(Yn_tables.begin(), Yn_tables, it);
+	}
+	return Yn_tables.front();
+}
 
 
 // This function calculates the Y_n. The Y_n are needed for the evaluation of S_{n,p}(x).
@@ -1773,16 +2161,15 @@ int ynlength = 100; // initial length of all Yn[i]
 // The second index in Y_n corresponds to the running index of the outermost sum in the full Z-sum
 // representing S_{n,p}(x).
 // The calculation of Y_n uses the values from Y_{n-1}.
-void fill_Yn(int n, const cln::float_format_t& prec)
+void fill_Yn(Yn_table& t, int n)
 {
-	const int initsize = ynlength;
-	//const int initsize = initsize_Yn;
-	cln::cl_N one = cln::cl_float(1, prec);
+	const int initsize = t.ynlength;
+	cln::cl_N one = cln::cl_float(1, t.prec);
 
 	if (n) {
 		std::vector<cln::cl_N> buf(initsize);
 		std::vector<cln::cl_N>::iterator it = buf.begin();
-		std::vector<cln::cl_N>::iterator itprev = Yn[n-1].begin();
+		std::vector<cln::cl_N>::iterator itprev = t.Yn[n-1].begin();
 		*it = (*itprev) / cln::cl_N(n+1) * one;
 		it++;
 		itprev++;
@@ -1793,7 +2180,7 @@ void fill_Yn(int n, const cln::float_format_t& prec)
 			it++;
 			itprev++;
 		}
-		Yn.push_back(buf);
+		t.Yn.push_back(buf);
 	} else {
 		std::vector<cln::cl_N> buf(initsize);
 		std::vector<cln::cl_N>::iterator it = buf.begin();
@@ -1803,40 +2190,51 @@ void fill_Yn(int n, const cln::float_format_t& prec)
 			*it = *(it-1) + 1 / cln::cl_N(i) * one;
 			it++;
 		}
-		Yn.push_back(buf);
+		t.Yn.push_back(buf);
 	}
-	ynsize++;
+	t.ynsize++;
 }
 
 
 // make Yn longer ... 
-void make_Yn_longer(int newsize, const cln::float_format_t& prec)
+void make_Yn_longer(Yn_table& t, int newsize)
 {
 
-	cln::cl_N one = cln::cl_float(1, prec);
+	cln::cl_N one = cln::cl_float(1, t.prec);
 
-	Yn[0].resize(newsize);
-	std::vector<cln::cl_N>::iterator it = Yn[0].begin();
-	it += ynlength;
-	for (int i=ynlength+1; i<=newsize; i++) {
+	t.Yn[0].resize(newsize);
+	std::vector<cln::cl_N>::iterator it = t.Yn[0].begin();
+	it += t.ynlength;
+	for (int i=t.ynlength+1; i<=newsize; i++) {
 		*it = *(it-1) + 1 / cln::cl_N(i) * one;
 		it++;
 	}
 
-	for (int n=1; n<ynsize; n++) {
-		Yn[n].resize(newsize);
-		std::vector<cln::cl_N>::iterator it = Yn[n].begin();
-		std::vector<cln::cl_N>::iterator itprev = Yn[n-1].begin();
-		it += ynlength;
-		itprev += ynlength;
-		for (int i=ynlength+n+1; i<=newsize+n; i++) {
+	for (int n=1; n<t.ynsize; n++) {
+		t.Yn[n].resize(newsize);
+		std::vector<cln::cl_N>::iterator it = t.Yn[n].begin();
+		std::vector<cln::cl_N>::iterator itprev = t.Yn[n-1].begin();
+		it += t.ynlength;
+		itprev += t.ynlength;
+		for (int i=t.ynlength+n+1; i<=newsize+n; i++) {
 			*it = *(it-1) + (*itprev) / cln::cl_N(i) * one;
 			it++;
 			itprev++;
 		}
 	}
 	
-	ynlength = newsize;
+	t.ynlength = newsize;
+}
+
+
+// makes sure that Yn[0] ... Yn[p-2] exist
+void prepare_Yn(Yn_table& t, int p)
+{
+	if (p > t.ynsize+1) {
+		for (int i=t.ynsize; i<p-1; i++) {
+			fill_Yn(t, i);
+		}
+	}
 }
 
 
@@ -1937,28 +2335,43 @@ cln::cl_N b_k(int k)
 }
 
 
+// helper function for S(n,p,x), summation in double precision
+cdouble S_do_sum_double(int n, int p, const cdouble& x, Yn_table& t)
+{
+	cdouble res;
+	cdouble resbuf;
+	cdouble factor = std::pow(x, p);
+	int i = p;
+	do {
+		resbuf = res;
+		if (i-p >= t.ynlength) {
+			// make Yn longer
+			make_Yn_longer(t, t.ynlength*2);
+		}
+		res = res + factor / std::pow(double(i), n+1) * cln::double_approx(cln::realpart(t.Yn[p-2][i-p]));
+		factor = factor * x;
+		i++;
+	} while (changing(res, resbuf));
+	
+	return res;
+}
+
+
 // helper function for S(n,p,x)
 cln::cl_N S_do_sum(int n, int p, const cln::cl_N& x, const cln::float_format_t& prec)
 {
-	static cln::float_format_t oldprec = cln::default_float_format;
-
 	if (p==1) {
 		return Li_projection(n+1, x, prec);
 	}
 
-	// precision has changed, we need to clear lookup table Yn
-	if ( oldprec != prec ) {
-		Yn.clear();
-		ynsize = 0;
-		ynlength = 100;
-		oldprec = prec;
-	}
-		
-	// check if precalculated values are sufficient
-	if (p > ynsize+1) {
-		for (int i=ynsize; i<p-1; i++) {
-			fill_Yn(i, prec);
-		}
+	// check if precalculated values for this precision are sufficient
+	Yn_table& t = get_Yn_table(prec);
+	prepare_Yn(t, p);
+
+	if (use_double_sums()) {
+		const cdouble res = S_do_sum_double(n, p, to_cdouble(x), t);
+		if (is_finite(res))
+			return from_cdouble(res);
 	}
 
 	// should be done otherwise
@@ -1972,11 +2385,11 @@ cln::cl_N S_do_sum(int n, int p, const cln::cl_N& x, const cln::float_format_t&
 	int i = p;
 	do {
 		resbuf = res;
-		if (i-p >= ynlength) {
+		if (i-p >= t.ynlength) {
 			// make Yn longer
-			make_Yn_longer(ynlength*2, prec);
+			make_Yn_longer(t, t.ynlength*2);
 		}
-		res = res + factor / cln::expt(cln::cl_I(i),n+1) * Yn[p-2][i-p]; // should we check it? or rely on magic number? ...
+		res = res + factor / cln::expt(cln::cl_I(i),n+1) * t.Yn[p-2][i-p]; // should we check it? or rely on magic number? ...
 		//res = res + factor / cln::expt(cln::cl_I(i),n+1) * (*it); // should we check it? or rely on magic number? ...
 		factor = factor * xf;
 		i++;
@@ -2260,7 +2673,18 @@ REGISTER_FUNCTION(S,
                   series_func(S_series).
                   derivative_func(S_deriv).
                   print_func<print_latex>(S_print_latex).
-                  do_not_evalf_params());
+                  do_not_evalf_params().
+                  persistent_evalf());
+
+
+// precomputes the lookup tables Xn and Yn (for the current precision) of
+// the calling thread
+void prepare_polylog_tables(int weight)
+{
+	prepare_Xn(weight);
+	if (weight > 2)
+		prepare_Yn(get_Yn_table(cln::float_format(Digits)), weight - 1);
+}
 
 
 //////////////////////////////////////////////////////////////////////
@@ -3124,9 +3548,40 @@ struct map_trafo_H_1mxt1px : public map_function
 };
 
 
+// do the actual summation in double precision.
+cdouble H_do_sum_double(const std::vector<int>& m, const cdouble& x)
+{
+	const int j = m.size();
+
+	std::vector<cdouble> t(j);
+
+	cdouble factor = std::pow(x, j);
+	cdouble t0buf;
+	int q = 0;
+	do {
+		t0buf = t[0];
+		q++;
+		t[j-1] = t[j-1] + 1.0 / std::pow(double(q), m[j-1]);
+		for (int k=j-2; k>=1; k--) {
+			t[k] = t[k] + t[k+1] / std::pow(double(q+j-1-k), m[k]);
+		}
+		t[0] = t[0] + t[1] * factor / std::pow(double(q+j-1), m[0]);
+		factor = factor * x;
+	} while (changing(t[0], t0buf));
+
+	return t[0];
+}
+
+
 // do the actual summation.
 cln::cl_N H_do_sum(const std::vector<int>& m, const cln::cl_N& x)
 {
+	if (use_double_sums()) {
+		const cdouble res = H_do_sum_double(m, to_cdouble(x));
+		if (is_finite(res))
+			return from_cdouble(res);
+	}
+
 	const int j = m.size();
 
 	std::vector<cln::cl_N> t(j);
@@ -3475,7 +3930,8 @@ REGISTER_FUNCTION(H,
                   series_func(H_series).
                   derivative_func(H_deriv).
                   print_func<print_latex>(H_print_latex).
-                  do_not_evalf_params());
+                  do_not_evalf_params().
+                  persistent_evalf());
 
 
 // takes a parameter list for H and returns an expression with corresponding multiple polylogarithms
@@ -3569,6 +4025,24 @@ static cln::cl_N crandall_Y_loop(const cln::cl_N& Sqk,
 }
 
 
+// crandall_Y_loop in double precision
+static double crandall_Y_loop_double(int Sqk, const std::vector<double>& crX)
+{
+	const double lambda_d = 319.0/320.0;
+	double factor = std::pow(lambda_d, Sqk);
+	double res = factor / Sqk * crX[0];
+	double resbuf;
+	int N = 0;
+	do {
+		resbuf = res;
+		factor = factor * lambda_d;
+		N++;
+		res = res + crX[N] * factor / (N+Sqk);
+	} while (changing(res, resbuf) || (crX[N] == 0));
+	return res;
+}
+
+
 // [Cra] section 4
 static void calc_f(std::vector<std::vector<cln::cl_N> >& f_kj,
 	           const int maxr, const int L1)
@@ -3634,6 +4108,43 @@ static cln::cl_N crandall_Z(const std::vector<int>& s,
 }
 
 
+// crandall_Z in double precision
+static double crandall_Z_double(const std::vector<int>& s,
+	                        const std::vector<std::vector<double> >& f_kj)
+{
+	const int j = s.size();
+
+	if (j == 1) {	
+		double t0 = 0;
+		double t0buf;
+		int q = 0;
+		do {
+			t0buf = t0;
+			q++;
+			t0 = t0 + f_kj[q+j-2][s[0]-1];
+		} while (changing(t0, t0buf));
+		
+		return t0 / cln::double_approx(cln::factorial(s[0]-1));
+	}
+
+	std::vector<double> t(j);
+
+	double t0buf;
+	int q = 0;
+	do {
+		t0buf = t[0];
+		q++;
+		t[j-1] = t[j-1] + 1 / std::pow(double(q), s[j-1]);
+		for (int k=j-2; k>=1; k--) {
+			t[k] = t[k] + t[k+1] / std::pow(double(q+j-1-k), s[k]);
+		}
+		t[0] = t[0] + t[1] * f_kj[q+j-2][s[0]-1];
+	} while (changing(t[0], t0buf));
+	
+	return t[0] / cln::double_approx(cln::factorial(s[0]-1));
+}
+
+
 // [Cra] (2.4)
 cln::cl_N zeta_do_sum_Crandall(const std::vector<int>& s)
 {
@@ -3679,6 +4190,14 @@ cln::cl_N zeta_do_sum_Crandall(const std::vector<int>& s)
 	std::vector<std::vector<cln::cl_N> > f_kj(L1);
 	calc_f(f_kj, maxr, L1);
 
+	const bool use_double = use_double_sums();
+	std::vector<std::vector<double> > f_kjd;
+	if (use_double) {
+		f_kjd.reserve(L1);
+		for (std::size_t i = 0; i < L1; i++)
+			f_kjd.push_back(to_double(f_kj[i]));
+	}
+
 	const cln::cl_N r0factorial = cln::factorial(r[0]-1);
 
 	std::vector<int> rz;
@@ -3693,11 +4212,20 @@ cln::cl_N zeta_do_sum_Crandall(const std::vector<int>& s)
 
 		std::vector<cln::cl_N> crX;
 		initcX(crX, r, L2);
+		std::vector<double> crXd;
+		if (use_double)
+			crXd = to_double(crX);
 		
 		for (int q=0; q<skp1buf; q++) {
 			
-			cln::cl_N pp1 = crandall_Y_loop(Srun+q-k, crX);
-			cln::cl_N pp2 = crandall_Z(rz, f_kj);
+			cln::cl_N pp1, pp2;
+			if (use_double) {
+				pp1 = cln::cl_DF(crandall_Y_loop_double(Srun+q-k, crXd));
+				pp2 = cln::cl_DF(crandall_Z_double(rz, f_kjd));
+			} else {
+				pp1 = crandall_Y_loop(Srun+q-k, crX);
+				pp2 = crandall_Z(rz, f_kj);
+			}
 
 			rz.front()--;
 			
@@ -3714,15 +4242,46 @@ cln::cl_N zeta_do_sum_Crandall(const std::vector<int>& s)
 	std::vector<cln::cl_N> crX;
 	initcX(crX, rz, L2);
 
-	res = (res + crandall_Y_loop(S-j, crX)) / r0factorial
-		+ crandall_Z(rz, f_kj);
+	if (use_double) {
+		res = (res + cln::cl_DF(crandall_Y_loop_double(S-j, to_double(crX)))) / r0factorial
+			+ cln::cl_DF(crandall_Z_double(rz, f_kjd));
+	} else {
+		res = (res + crandall_Y_loop(S-j, crX)) / r0factorial
+			+ crandall_Z(rz, f_kj);
+	}
 
 	return res;
 }
 
 
+// zeta_do_sum_simple in double precision
+double zeta_do_sum_simple_double(const std::vector<int>& r)
+{
+	const int j = r.size();
+
+	// buffer for subsums
+	std::vector<double> t(j);
+
+	double t0buf;
+	int q = 0;
+	do {
+		t0buf = t[0];
+		q++;
+		t[j-1] = t[j-1] + 1 / std::pow(double(q), r[j-1]);
+		for (int k=j-2; k>=0; k--) {
+			t[k] = t[k] + t[k+1] / std::pow(double(q+j-1-k), r[k]);
+		}
+	} while (changing(t[0], t0buf));
+
+	return t[0];
+}
+
+
 cln::cl_N zeta_do_sum_simple(const std::vector<int>& r)
 {
+	if (use_double_sums())
+		return cln::cl_DF(zeta_do_sum_simple_double(r));
+
 	const int j = r.size();
 
 	// buffer for subsums
@@ -3968,6 +4527,7 @@ unsigned zeta1_SERIAL::serial = function::register_new(function_options("zeta",
                                 derivative_func(zeta1_deriv).
                                 print_func<print_latex>(zeta1_print_latex).
                                 do_not_evalf_params().
+                                persistent_evalf().
                                 overloaded(2));
 
 
@@ -4105,6 +4665,7 @@ unsigned zeta2_SERIAL::serial = function::register_new(function_options("zeta",
                                 derivative_func(zeta2_deriv).
                                 print_func<print_latex>(zeta2_print_latex).
                                 do_not_evalf_params().
+                                persistent_evalf().
                                 overloaded(2));
 
 
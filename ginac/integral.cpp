@@ -33,6 +33,12 @@
 #include "utils.h"
 #include "operators.h"
 #include "relational.h"
+#include "function.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
 
 using namespace std;
 
@@ -188,7 +194,7 @@ ex integral::evalf(int level) const
 	// results after subsituting a number for the integration variable.
 	if (is_exactly_a<numeric>(ea) && is_exactly_a<numeric>(eb) 
 			&& is_exactly_a<numeric>(ef.subs(x==12.34).evalf())) {
-			return adaptivesimpson(x, ea, eb, ef);
+			return adaptivegauss(x, ea, eb, ef);
 	}
 
 	if (are_ex_trivially_equal(a, ea) && are_ex_trivially_equal(b, eb)
@@ -323,6 +329,284 @@ ex adaptivesimpson(const ex & x, const ex & a_in, const ex & b_in, const ex & f,
 	return app;
 }
 
+namespace {
+
+/** An integrand translated once into a program for a stack machine, so that
+ *  evaluating it at a number does not need to substitute the number into
+ *  the expression tree and evaluate the resulting tree.  Sums, products,
+ *  powers and functions are computed directly on numerics.  Subexpressions
+ *  that do not depend on the integration variable are evaluated in advance,
+ *  anything else is evaluated with subs() and evalf(). */
+class integrand {
+public:
+	integrand(const ex & x_, const ex & f) : x(x_) { compile(f); }
+
+	numeric operator()(const numeric & value) const;
+
+private:
+	enum opcode {
+		push_constant,  ///< push constants[arg]
+		push_variable,  ///< push the value of the integration variable
+		add_args,       ///< replace the top arg values by their sum
+		mul_args,       ///< replace the top arg values by their product
+		power_args,     ///< replace basis and exponent by the power
+		call_function,  ///< replace the top nargs values by function arg of them
+		evaluate_other  ///< push others[arg] evaluated at the variable
+	};
+
+	struct instruction {
+		instruction(opcode o, size_t a, size_t n = 0) : op(o), arg(a), nargs(n) {}
+		opcode op;
+		size_t arg;
+		size_t nargs;
+	};
+
+	void compile(const ex & e);
+
+	ex x;
+	std::vector<instruction> code;
+	std::vector<numeric> constants;
+	exvector others;
+};
+
+/** Check whether the arguments of a function that don't depend on x are
+ *  numbers, so it can be called with numbers for all of them. */
+bool numeric_arguments(const ex & f, const ex & x)
+{
+	for (size_t i=0; i<f.nops(); ++i)
+		if (!f.op(i).has(x) && !is_exactly_a<numeric>(f.op(i).evalf()))
+			return false;
+	return true;
+}
+
+void integrand::compile(const ex & e)
+{
+	if (is_exactly_a<numeric>(e)) {
+		code.push_back(instruction(push_constant, constants.size()));
+		constants.push_back(ex_to<numeric>(e));
+	} else if (e.is_equal(x)) {
+		code.push_back(instruction(push_variable, 0));
+	} else if (!e.has(x)) {
+		const ex value = e.evalf();
+		if (is_exactly_a<numeric>(value)) {
+			code.push_back(instruction(push_constant, constants.size()));
+			constants.push_back(ex_to<numeric>(value));
+		} else {
+			// Not a number, like the lists of indices of H() or G(); if
+			// it is the whole integrand, subsvalue() reports the error
+			code.push_back(instruction(evaluate_other, others.size()));
+			others.push_back(e);
+		}
+	} else if (is_exactly_a<add>(e) || is_exactly_a<mul>(e)) {
+		for (size_t i=0; i<e.nops(); ++i)
+			compile(e.op(i));
+		code.push_back(instruction(is_exactly_a<add>(e) ? add_args : mul_args, e.nops()));
+	} else if (is_exactly_a<power>(e)) {
+		compile(e.op(0));
+		compile(e.op(1));
+		code.push_back(instruction(power_args, 0));
+	} else if (is_exactly_a<function>(e) && numeric_arguments(e, x)) {
+		for (size_t i=0; i<e.nops(); ++i)
+			compile(e.op(i));
+		code.push_back(instruction(call_function, ex_to<function>(e).get_serial(), e.nops()));
+	} else {
+		code.push_back(instruction(evaluate_other, others.size()));
+		others.push_back(e);
+	}
+}
+
+numeric integrand::operator()(const numeric & value) const
+{
+	std::vector<numeric> stack;
+	for (std::vector<instruction>::const_iterator i = code.begin(); i != code.end(); ++i) {
+		switch (i->op) {
+			case push_constant:
+				stack.push_back(constants[i->arg]);
+				break;
+			case push_variable:
+				stack.push_back(value);
+				break;
+			case add_args: {
+				numeric sum = stack.back();
+				for (size_t j=1; j<i->arg; ++j) {
+					stack.pop_back();
+					sum += stack.back();
+				}
+				stack.back() = sum;
+				break;
+			}
+			case mul_args: {
+				numeric prod = stack.back();
+				for (size_t j=1; j<i->arg; ++j) {
+					stack.pop_back();
+					prod *= stack.back();
+				}
+				stack.back() = prod;
+				break;
+			}
+			case power_args: {
+				numeric exponent = stack.back();
+				stack.pop_back();
+				stack.back() = stack.back().power(exponent);
+				break;
+			}
+			case call_function: {
+				exvector args(stack.end() - i->nargs, stack.end());
+				stack.resize(stack.size() - i->nargs);
+				ex result = function(i->arg, args).evalf();
+				if (!is_exactly_a<numeric>(result))
+					throw logic_error("integrand does not evaluate to numeric");
+				stack.push_back(ex_to<numeric>(result));
+				break;
+			}
+			case evaluate_other:
+				stack.push_back(ex_to<numeric>(subsvalue(x, value, others[i->arg])));
+				break;
+		}
+	}
+	GINAC_ASSERT(stack.size() == 1);
+	return stack.back();
+}
+
+/** Number of points of the Gauss-Legendre rule used by adaptivegauss(). */
+const unsigned gauss_points = 10;
+
+/** Nodes and weights of the Gauss-Legendre rule on [-1,1], computed by
+ *  Newton's method at the current precision.  The results are remembered
+ *  for every precision asked for. */
+const std::vector<std::pair<numeric, numeric> > & gauss_legendre_rule()
+{
+	static std::map<long, std::vector<std::pair<numeric, numeric> > > rules;
+	std::vector<std::pair<numeric, numeric> > & rule = rules[Digits];
+	if (!rule.empty())
+		return rule;
+
+	const unsigned points = gauss_points;
+	const numeric eps = numeric(1, 10).power(numeric(long(Digits)));
+	const double pi = 3.14159265358979323846;
+	for (unsigned k=1; k<=points; ++k) {
+		numeric z = numeric(std::cos(pi * (k - 0.25) / (points + 0.5)));
+		numeric dp;
+		for (int iteration=0; iteration<100; ++iteration) {
+
+			// Legendre polynomial and its derivative by the recurrence
+			numeric p = *_num1_p, p_prev = *_num0_p;
+			for (unsigned j=1; j<=points; ++j) {
+				numeric p_prev2 = p_prev;
+				p_prev = p;
+				p = ((2*j - 1) * z * p_prev - (j - 1) * p_prev2) / j;
+			}
+			dp = points * (z * p - p_prev) / (z * z - *_num1_p);
+			numeric dz = p / dp;
+			z -= dz;
+			if (abs(dz) <= eps)
+				break;
+		}
+		rule.push_back(std::make_pair(z, numeric(2) / ((*_num1_p - z * z) * dp * dp)));
+	}
+	return rule;
+}
+
+/** Gauss-Legendre approximation of the integral of f over [a,b]. */
+numeric gauss_legendre(const integrand & f, const numeric & a, const numeric & b)
+{
+	const std::vector<std::pair<numeric, numeric> > & rule = gauss_legendre_rule();
+	const numeric mid = (a + b) / 2;
+	const numeric half = (b - a) / 2;
+	numeric sum;
+	for (std::vector<std::pair<numeric, numeric> >::const_iterator i = rule.begin(); i != rule.end(); ++i)
+		sum += i->second * f(mid + half * i->first);
+	return half * sum;
+}
+
+/** A subinterval in adaptivegauss(), with the Gauss-Legendre approximations
+ *  for the whole of it and for its halves. */
+struct subinterval {
+	subinterval(const integrand & f, const numeric & a_, const numeric & b_, const numeric & whole, int level_)
+		: a(a_), b(b_), level(level_)
+	{
+		const numeric mid = (a + b) / 2;
+		left = gauss_legendre(f, a, mid);
+		right = gauss_legendre(f, mid, b);
+		value = left + right;
+		error = abs(value - whole);
+	}
+
+	bool operator<(const subinterval & other) const { return error < other.error; }
+
+	numeric a, b;
+	numeric left, right;  ///< approximations for the halves
+	numeric value;        ///< best approximation, left + right
+	numeric error;        ///< estimated error of the approximation for the whole
+	int level;            ///< number of halvings of the integration domain
+};
+
+} // anonymous namespace
+
+/** Numeric integration routine based on Gauss-Legendre quadrature. The
+  * integrand is translated once into a form that can be evaluated quickly
+  * (see above). The domain is split adaptively, always halving the
+  * subinterval with the largest estimated error, until the sum of the error
+  * estimates is below the requested relative error. The error of a
+  * subinterval is estimated from the difference between the rules for the
+  * whole of it and for its halves.  Parameters are as for
+  * adaptivesimpson(). */
+ex adaptivegauss(const ex & x, const ex & a_in, const ex & b_in, const ex & f, const ex & error)
+{
+	// Check whether boundaries and error are numbers.
+	ex a = is_exactly_a<numeric>(a_in) ? a_in : a_in.evalf();
+	ex b = is_exactly_a<numeric>(b_in) ? b_in : b_in.evalf();
+	if(!is_exactly_a<numeric>(a) || !is_exactly_a<numeric>(b))
+		throw std::runtime_error("For numerical integration the boundaries of the integral should evalf into numbers.");
+	if(!is_exactly_a<numeric>(error))
+		throw std::runtime_error("For numerical integration the error should be a number.");
+
+	// Use lookup table to be potentially much faster.
+	static lookup_map lookup;
+	static symbol ivar("ivar");
+	ex lookupex = integral(ivar,a,b,f.subs(x==ivar));
+	lookup_map::iterator emi = lookup.find(error_and_integral(error, lookupex));
+	if (emi!=lookup.end())
+		return emi->second;
+
+	const integrand fun(x, f.evalf());
+	const numeric na = ex_to<numeric>(a);
+	const numeric nb = ex_to<numeric>(b);
+	const numeric tolerance = ex_to<numeric>(error);
+
+	// The subintervals, as a heap with the largest error on top
+	std::vector<subinterval> heap;
+	heap.push_back(subinterval(fun, na, nb, gauss_legendre(fun, na, nb), 1));
+	numeric total_error = heap.front().error;
+	numeric abs_total = abs(heap.front().value);
+
+	while (total_error > tolerance * abs_total) {
+		std::pop_heap(heap.begin(), heap.end());
+		const subinterval worst = heap.back();
+		heap.pop_back();
+		if (worst.level >= integral::max_integration_level)
+			throw runtime_error("max integration level reached");
+
+		const numeric mid = (worst.a + worst.b) / 2;
+		const subinterval left(fun, worst.a, mid, worst.left, worst.level + 1);
+		const subinterval right(fun, mid, worst.b, worst.right, worst.level + 1);
+		total_error += left.error + right.error - worst.error;
+		abs_total += abs(left.value) + abs(right.value) - abs(worst.value);
+		heap.push_back(left);
+		std::push_heap(heap.begin(), heap.end());
+		heap.push_back(right);
+		std::push_heap(heap.begin(), heap.end());
+	}
+
+	numeric sum;
+	for (std::vector<subinterval>::const_iterator i = heap.begin(); i != heap.end(); ++i)
+		sum += i->value;
+	ex app = sum;
+
+	lookup[error_and_integral(error, lookupex)]=app;
+	return app;
+}
+
 int integral::degree(const ex & s) const
 {
 	return ((b-a)*f).degree(s);
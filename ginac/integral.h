@@ -91,6 +91,14 @@ GiNaC::ex adaptivesimpson(
 	const GiNaC::ex &error = integral::relative_integration_error
 );
 
+GiNaC::ex adaptivegauss(
+	const GiNaC::ex &x,
+	const GiNaC::ex &a,
+	const GiNaC::ex &b,
+	const GiNaC::ex &f,
+	const GiNaC::ex &error = integral::relative_integration_error
+);
+
 } // namespace GiNaC
 
 #endif // ndef GINAC_INTEGRAL_H
@@ -21,6 +21,7 @@
  */
 
 #include "matrix.h"
+#include "cancellation.h"
 #include "numeric.h"
 #include "lst.h"
 #include "idx.h"
@@ -1193,6 +1194,7 @@ ex matrix::determinant_minor() const
 			Pkey.push_back(i);
 		unsigned fc = 0;  // controls logic for our strange flipper counter
 		do {
+			cancellation::poll("determinant");
 			det = _ex0;
 			for (unsigned r=0; r<n-c; ++r) {
 				// maybe there is nothing to do?
@@ -1262,6 +1264,7 @@ int matrix::gauss_elimination(const bool det)
 			if (indx > 0)
 				sign = -sign;
 			for (unsigned r2=r0+1; r2<m; ++r2) {
+				cancellation::poll("matrix elimination");
 				if (!this->m[r2*n+c0].is_zero()) {
 					// yes, there is something to do in this row
 					ex piv = this->m[r2*n+c0] / this->m[r0*n+c0];
@@ -1321,6 +1324,7 @@ int matrix::division_free_elimination(const bool det)
 			if (indx>0)
 				sign = -sign;
 			for (unsigned r2=r0+1; r2<m; ++r2) {
+				cancellation::poll("matrix elimination");
 				for (unsigned c=c0+1; c<n; ++c)
 					this->m[r2*n+c] = (this->m[r0*n+c0]*this->m[r2*n+c] - this->m[r2*n+c0]*this->m[r0*n+c]).expand();
 				// fill up left hand side with zeros
@@ -1437,6 +1441,7 @@ int matrix::fraction_free_elimination(const bool det)
 				}
 			}
 			for (unsigned r2=r0+1; r2<m; ++r2) {
+				cancellation::poll("matrix elimination");
 				for (unsigned c=c0+1; c<n; ++c) {
 					dividend_n = (tmp_n.m[r0*n+c0]*tmp_n.m[r2*n+c]*
 					              tmp_d.m[r2*n+c0]*tmp_d.m[r0*n+c]
@@ -22,6 +22,7 @@
 
 #include "mul.h"
 #include "add.h"
+#include "cancellation.h"
 #include "power.h"
 #include "operators.h"
 #include "matrix.h"
@@ -496,6 +497,7 @@ ex mul::coeff(const ex & s, int n) const
  *  @param level cut-off in recursive evaluation */
 ex mul::eval(int level) const
 {
+	profiler::count(profiled_ops::mul_eval);
 	std::auto_ptr<epvector> evaled_seqp = evalchildren(level);
 	if (evaled_seqp.get()) {
 		// do more evaluation later
@@ -1203,6 +1205,7 @@ ex mul::expand(unsigned options) const
 
 				// Multiply explicitly all non-numeric terms of add1 and add2:
 				for (epvector::const_iterator i2=add2begin; i2!=add2end; ++i2) {
+					cancellation::poll("expand");
 					// We really have to combine terms here in order to compactify
 					// the result.  Otherwise it would become waayy tooo bigg.
 					numeric oc(*_num0_p);
@@ -1249,6 +1252,7 @@ ex mul::expand(unsigned options) const
 		}
 
 		for (size_t i=0; i<n; ++i) {
+			cancellation::poll("expand");
 			epvector factors = non_adds;
 			if (skip_idx_rename)
 				factors.push_back(split_ex_to_pair(last_expanded.op(i)));
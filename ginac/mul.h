@@ -60,7 +60,7 @@ public:
 	ex imag_part() const;
 	ex evalm() const;
 	ex series(const relational & s, int order, unsigned options = 0) const;
-	ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const;
+	ex normal(exmap & repl, exmap & rev_lookup, int level = 0, unsigned options = 0) const;
 	numeric integer_content() const;
 	ex smod(const numeric &xi) const;
 	numeric max_coefficient() const;
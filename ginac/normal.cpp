@@ -27,6 +27,7 @@
 #include "basic.h"
 #include "ex.h"
 #include "add.h"
+#include "cancellation.h"
 #include "constant.h"
 #include "expairseq.h"
 #include "fail.h"
@@ -42,9 +43,14 @@
 #include "symbol.h"
 #include "utils.h"
 #include "polynomial/chinrem_gcd.h"
+#include "polynomial/mpoly.h"
+#include "polynomial/zippel_gcd.h"
 
 #include <algorithm>
+#include <ctime>
+#include <list>
 #include <map>
+#include <ostream>
 
 namespace GiNaC {
 
@@ -71,6 +77,7 @@ static int gcd_called = 0;
 static int sr_gcd_called = 0;
 static int heur_gcd_called = 0;
 static int heur_gcd_failed = 0;
+static int gcd_cache_hits = 0;
 
 // Print statistics at end of program
 static struct _stat_print {
@@ -80,6 +87,7 @@ static struct _stat_print {
 		std::cout << "sr_gcd() called " << sr_gcd_called << " times\n";
 		std::cout << "heur_gcd() called " << heur_gcd_called << " times\n";
 		std::cout << "heur_gcd() failed " << heur_gcd_failed << " times\n";
+		std::cout << "gcd() results taken from cache " << gcd_cache_hits << " times\n";
 	}
 } stat_print;
 #endif
@@ -1075,6 +1083,7 @@ void ex::unitcontprim(const ex &x, ex &u, ex &c, ex &p) const
 
 static ex sr_gcd(const ex &a, const ex &b, sym_desc_vec::const_iterator var)
 {
+	profile_scope prof(profiled_ops::sr_gcd);
 #if STATISTICS
 	sr_gcd_called++;
 #endif
@@ -1112,6 +1121,7 @@ static ex sr_gcd(const ex &a, const ex &b, sym_desc_vec::const_iterator var)
 	int delta = cdeg - ddeg;
 
 	for (;;) {
+		cancellation::poll("gcd");
 
 		// Calculate polynomial pseudo-remainder
 		r = prem(c, d, x, false);
@@ -1324,6 +1334,7 @@ static bool heur_gcd_z(ex& res, const ex &a, const ex &b, ex *ca, ex *cb,
 
 	// 6 tries maximum
 	for (int t=0; t<6; t++) {
+		cancellation::poll("gcd");
 		if (xi.int_length() * maxdeg > 100000) {
 			throw gcdheu_failed();
 		}
@@ -1378,6 +1389,7 @@ static bool heur_gcd_z(ex& res, const ex &a, const ex &b, ex *ca, ex *cb,
 static bool heur_gcd(ex& res, const ex& a, const ex& b, ex *ca, ex *cb,
 	             sym_desc_vec::const_iterator var)
 {
+	profile_scope prof(profiled_ops::heur_gcd);
 	if (a.info(info_flags::integer_polynomial) && 
 	    b.info(info_flags::integer_polynomial)) {
 		try {
@@ -1425,6 +1437,182 @@ static ex gcd_pf_pow(const ex& a, const ex& b, ex* ca, ex* cb);
 // large expressions). At least one of the arguments should be a product.
 static ex gcd_pf_mul(const ex& a, const ex& b, ex* ca, ex* cb);
 
+static ex gcd_compute(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned options);
+
+namespace {
+
+/** Arguments of a cached gcd() call. */
+struct gcd_cache_key {
+	gcd_cache_key(const ex &a_, const ex &b_, unsigned o) : a(a_), b(b_), options(o) {}
+	ex a, b;
+	unsigned options;
+};
+
+struct gcd_cache_key_is_less {
+	bool operator()(const gcd_cache_key &k1, const gcd_cache_key &k2) const
+	{
+		if (k1.options != k2.options)
+			return k1.options < k2.options;
+		const int cmp = k1.a.compare(k2.a);
+		if (cmp != 0)
+			return cmp < 0;
+		return k1.b.compare(k2.b) < 0;
+	}
+};
+
+struct gcd_cache_entry {
+	ex g, ca, cb;
+	bool has_ca, has_cb;  ///< whether the cofactors were computed
+	double seconds;       ///< time it took to compute the entry
+	std::size_t bytes;    ///< approximate memory used by the entry
+};
+
+typedef std::map<gcd_cache_key, gcd_cache_entry, gcd_cache_key_is_less> gcd_cache_map;
+
+struct gcd_cache_state {
+	gcd_cache_state() : enabled(false), max_bytes(0), bytes(0), lookups(0), hits(0), seconds_saved(0) {}
+
+	bool enabled;
+	std::size_t max_bytes;
+	std::size_t bytes;
+	gcd_cache_map entries;
+	std::list<gcd_cache_map::iterator> age;  ///< oldest entry first
+	unsigned long lookups, hits;
+	double seconds_saved;
+};
+
+gcd_cache_state & gcd_cache_data()
+{
+	static gcd_cache_state s;
+	return s;
+}
+
+/** Rough estimate of the memory used by a polynomial, counting the terms
+ *  of a sum. */
+std::size_t approx_memory_size(const ex &e)
+{
+	const std::size_t term_size = sizeof(expair) + sizeof(mul);
+	if (is_exactly_a<add>(e))
+		return sizeof(add) + e.nops() * term_size;
+	return term_size;
+}
+
+/** Drop the oldest entries until at most three quarters of the memory
+ *  limit are used. */
+void gcd_cache_shrink()
+{
+	gcd_cache_state & s = gcd_cache_data();
+	while (!s.age.empty() && s.bytes > s.max_bytes / 4 * 3) {
+		s.bytes -= s.age.front()->second.bytes;
+		s.entries.erase(s.age.front());
+		s.age.pop_front();
+	}
+}
+
+/** gcd() with caching of the results.  The arguments are checked before
+ *  the lookup, so the key does not depend on check_args: a result cached
+ *  by an unchecked call is never returned for invalid arguments. */
+ex gcd_cached(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned options)
+{
+	if (check_args && (!a.info(info_flags::rational_polynomial) || !b.info(info_flags::rational_polynomial))) {
+		throw(std::invalid_argument("gcd: arguments must be polynomials over the rationals"));
+	}
+
+	gcd_cache_state & s = gcd_cache_data();
+	++s.lookups;
+
+	const gcd_cache_key key(a, b, options);
+	gcd_cache_map::iterator it = s.entries.find(key);
+	if (it != s.entries.end() && (it->second.has_ca || !ca) && (it->second.has_cb || !cb)) {
+#if STATISTICS
+		gcd_cache_hits++;
+#endif
+		++s.hits;
+		s.seconds_saved += it->second.seconds;
+		if (ca)
+			*ca = it->second.ca;
+		if (cb)
+			*cb = it->second.cb;
+		return it->second.g;
+	}
+
+	gcd_cache_entry entry;
+	const std::clock_t start = std::clock();
+	entry.g = gcd_compute(a, b, ca ? &entry.ca : NULL, cb ? &entry.cb : NULL, false, options);
+	entry.seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+	entry.has_ca = ca != NULL;
+	entry.has_cb = cb != NULL;
+	entry.bytes = sizeof(gcd_cache_entry) + approx_memory_size(entry.g)
+	            + approx_memory_size(entry.ca) + approx_memory_size(entry.cb);
+	if (ca)
+		*ca = entry.ca;
+	if (cb)
+		*cb = entry.cb;
+
+	// The computation may have changed the cache (recursive calls, or
+	// even disabled it), so look up the key again
+	if (s.enabled) {
+		it = s.entries.find(key);
+		if (it != s.entries.end()) {
+			s.bytes -= it->second.bytes;
+			it->second = entry;
+		} else {
+			it = s.entries.insert(std::make_pair(key, entry)).first;
+			s.age.push_back(it);
+		}
+		s.bytes += entry.bytes;
+		if (s.max_bytes != 0 && s.bytes > s.max_bytes)
+			gcd_cache_shrink();
+	}
+	return entry.g;
+}
+
+} // anonymous namespace
+
+void gcd_cache::enable(std::size_t max_bytes)
+{
+	gcd_cache_state & s = gcd_cache_data();
+	s.enabled = true;
+	s.max_bytes = max_bytes;
+	if (s.max_bytes != 0 && s.bytes > s.max_bytes)
+		gcd_cache_shrink();
+}
+
+void gcd_cache::disable()
+{
+	clear();
+	gcd_cache_data().enabled = false;
+}
+
+bool gcd_cache::is_enabled()
+{
+	return gcd_cache_data().enabled;
+}
+
+void gcd_cache::clear()
+{
+	gcd_cache_state & s = gcd_cache_data();
+	s.entries.clear();
+	s.age.clear();
+	s.bytes = 0;
+}
+
+std::size_t gcd_cache::size()
+{
+	return gcd_cache_data().entries.size();
+}
+
+void gcd_cache::show_statistics(std::ostream & os)
+{
+	const gcd_cache_state & s = gcd_cache_data();
+	os << "gcd cache: " << s.entries.size() << " entries, about "
+	   << s.bytes << " bytes" << std::endl;
+	os << "  " << s.lookups << " lookups, " << s.hits << " hits";
+	if (s.lookups)
+		os << " (" << 100.0 * s.hits / s.lookups << "%)";
+	os << ", " << s.seconds_saved << " s saved" << std::endl;
+}
+
 /** Compute GCD (Greatest Common Divisor) of multivariate polynomials a(X)
  *  and b(X) in Z[X]. Optionally also compute the cofactors of a and b,
  *  defined by a = ca * gcd(a, b) and b = cb * gcd(a, b).
@@ -1438,6 +1626,7 @@ static ex gcd_pf_mul(const ex& a, const ex& b, ex* ca, ex* cb);
  *  @return the GCD as a new expression */
 ex gcd(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned options)
 {
+	profile_scope prof(profiled_ops::gcd);
 #if STATISTICS
 	gcd_called++;
 #endif
@@ -1461,6 +1650,14 @@ ex gcd(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned optio
 		return g;
 	}
 
+	if (gcd_cache_data().enabled)
+		return gcd_cached(a, b, ca, cb, check_args, options);
+	return gcd_compute(a, b, ca, cb, check_args, options);
+}
+
+/** The work horse of gcd(), after numbers have been dealt with. */
+static ex gcd_compute(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned options)
+{
 	// Check arguments
 	if (check_args && (!a.info(info_flags::rational_polynomial) || !b.info(info_flags::rational_polynomial))) {
 		throw(std::invalid_argument("gcd: arguments must be polynomials over the rationals"));
@@ -1603,9 +1800,18 @@ ex gcd(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned optio
 		return g;
 	}
 
+	exvector vars;
+	for (std::size_t n = sym_stats.size(); n-- != 0; )
+		vars.push_back(sym_stats[n].sym);
+
+	// Sparse polynomials in many variables are best left to the sparse
+	// modular algorithm, the heuristic one would produce huge integers
+	const bool use_sparse = !(options & gcd_options::use_sr_gcd) &&
+		((options & gcd_options::use_sparse_gcd) || zippel_gcd_is_suitable(aex, bex, vars));
+
 	// Try heuristic algorithm first, fall back to PRS if that failed
 	ex g;
-	if (!(options & gcd_options::no_heur_gcd)) {
+	if (!use_sparse && !(options & gcd_options::no_heur_gcd)) {
 		bool found = heur_gcd(g, aex, bex, ca, cb, var);
 		if (found) {
 			// heur_gcd have already computed cofactors...
@@ -1627,10 +1833,16 @@ ex gcd(const ex &a, const ex &b, ex *ca, ex *cb, bool check_args, unsigned optio
 	if (options & gcd_options::use_sr_gcd) {
 		g = sr_gcd(aex, bex, var);
 	} else {
-		exvector vars;
-		for (std::size_t n = sym_stats.size(); n-- != 0; )
-			vars.push_back(sym_stats[n].sym);
-		g = chinrem_gcd(aex, bex, vars);
+		bool found = false;
+		if (use_sparse) {
+			try {
+				g = zippel_gcd(aex, bex, vars);
+				found = true;
+			} catch (zippel_gcd_failed &) {
+			}
+		}
+		if (!found)
+			g = chinrem_gcd(aex, bex, vars);
 	}
 
 	if (g.is_equal(_ex1)) {
@@ -2046,14 +2258,15 @@ static ex replace_with_symbol(const ex & e, exmap & repl)
 /** Function object to be applied by basic::normal(). */
 struct normal_map_function : public map_function {
 	int level;
-	normal_map_function(int l) : level(l) {}
-	ex operator()(const ex & e) { return normal(e, level); }
+	unsigned options;
+	normal_map_function(int l, unsigned o) : level(l), options(o) {}
+	ex operator()(const ex & e) { return normal(e, level, options); }
 };
 
 /** Default implementation of ex::normal(). It normalizes the children and
  *  replaces the object with a temporary symbol.
  *  @see ex::normal */
-ex basic::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex basic::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	if (nops() == 0)
 		return (new lst(replace_with_symbol(*this, repl, rev_lookup), _ex1))->setflag(status_flags::dynallocated);
@@ -2063,7 +2276,7 @@ ex basic::normal(exmap & repl, exmap & rev_lookup, int level) const
 		else if (level == -max_recursion_level)
 			throw(std::runtime_error("max recursion level reached"));
 		else {
-			normal_map_function map_normal(level - 1);
+			normal_map_function map_normal(level - 1, options);
 			return (new lst(replace_with_symbol(map(map_normal), repl, rev_lookup), _ex1))->setflag(status_flags::dynallocated);
 		}
 	}
@@ -2072,7 +2285,7 @@ ex basic::normal(exmap & repl, exmap & rev_lookup, int level) const
 
 /** Implementation of ex::normal() for symbols. This returns the unmodified symbol.
  *  @see ex::normal */
-ex symbol::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex symbol::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	return (new lst(*this, _ex1))->setflag(status_flags::dynallocated);
 }
@@ -2082,7 +2295,7 @@ ex symbol::normal(exmap & repl, exmap & rev_lookup, int level) const
  *  into re+I*im and replaces I and non-rational real numbers with a temporary
  *  symbol.
  *  @see ex::normal */
-ex numeric::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex numeric::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	numeric num = numer();
 	ex numex = num;
@@ -2163,10 +2376,125 @@ static ex frac_cancel(const ex &n, const ex &d)
 }
 
 
+/** Enables the gcd_cache for the lifetime of the object if the options
+ *  ask for normal_options::cache_gcd and it is not enabled yet, and
+ *  disables it again afterwards, also when an exception is thrown. */
+class normal_gcd_cache_scope {
+public:
+	explicit normal_gcd_cache_scope(unsigned options) : own_cache(false)
+	{
+		if ((options & normal_options::cache_gcd) && !gcd_cache::is_enabled()) {
+			gcd_cache::enable();
+			own_cache = true;
+		}
+	}
+	~normal_gcd_cache_scope()
+	{
+		if (own_cache)
+			gcd_cache::disable();
+	}
+private:
+	normal_gcd_cache_scope(const normal_gcd_cache_scope &);
+	normal_gcd_cache_scope & operator=(const normal_gcd_cache_scope &);
+
+	bool own_cache;
+};
+
+/** Sums with at least this many fractions are added with
+ *  normal_options::balanced_sum unless told otherwise. */
+static const std::size_t balanced_sum_threshold = 16;
+
+/** Numerator of a sum of fractions under construction.  As long as the
+ *  numerators and the cofactors of the denominators are polynomials with
+ *  integer coefficients, it is kept as an mpoly, so that multiplying it
+ *  with cofactors and adding does not build and expand expression trees
+ *  over and over again.  It is converted back to an expression only once
+ *  at the end.  The denominators, their GCDs and the cancellation of the
+ *  result are not affected and still work on expressions. */
+class frac_numerator {
+public:
+	explicit frac_numerator(const exvector & vars_) : vars(&vars_), native(false) {}
+
+	void assign(const ex & n)
+	{
+		native = ex_to_mpoly(poly, n, *vars);
+		expr = native ? _ex0 : n;
+	}
+
+	/** Replace this by this*c1 + other*c2. */
+	void mul_add(const ex & c1, const frac_numerator & other, const ex & c2)
+	{
+		mpoly p1, p2;
+		if (native && other.native && ex_to_mpoly(p1, c1, *vars) && ex_to_mpoly(p2, c2, *vars)) {
+			mpoly t1, t2;
+			mpoly_mul(t1, poly, p1);
+			mpoly_mul(t2, other.poly, p2);
+			mpoly_add(poly, t1, t2);
+			return;
+		}
+		expr = ((to_ex() * c1) + (other.to_ex() * c2)).expand();
+		native = false;
+		poly.clear();
+	}
+
+	ex to_ex() const
+	{
+		return native ? mpoly_to_ex(poly, *vars) : expr;
+	}
+
+private:
+	const exvector * vars;  ///< variables of poly
+	bool native;            ///< whether the value is in poly or in expr
+	mpoly poly;
+	ex expr;
+};
+
+/** Symbols occurring in the numerators and denominators of a sum. */
+static exvector fraction_symbols(const exvector & nums, const exvector & dens)
+{
+	sym_desc_vec v;
+	for (std::size_t i = 0; i < nums.size(); ++i) {
+		collect_symbols(nums[i], v);
+		collect_symbols(dens[i], v);
+	}
+	exvector vars;
+	vars.reserve(v.size());
+	for (sym_desc_vec::const_iterator i = v.begin(); i != v.end(); ++i)
+		vars.push_back(i->sym);
+	return vars;
+}
+
+/** Add the fractions nums[i]/dens[i] for first <= i < last by adding the
+ *  sums of both halves of the range.  This keeps the operands of the gcd()
+ *  calls small, while adding the fractions one after another compares the
+ *  ever growing common denominator with each new denominator. */
+static void add_fractions_balanced(const exvector & nums, const exvector & dens,
+                                   std::size_t first, std::size_t last,
+                                   frac_numerator & num, ex & den)
+{
+	cancellation::poll("normal");
+	if (last - first == 1) {
+		num.assign(nums[first]);
+		den = dens[first];
+		return;
+	}
+
+	const std::size_t mid = first + (last - first) / 2;
+	frac_numerator num2 = num;
+	ex den1, den2;
+	add_fractions_balanced(nums, dens, first, mid, num, den1);
+	add_fractions_balanced(nums, dens, mid, last, num2, den2);
+
+	ex co_den1, co_den2;
+	ex g = gcd(den1, den2, &co_den1, &co_den2, false);
+	num.mul_add(co_den2, num2, co_den1);
+	den = den1 * co_den2;	// this is the lcm(den1, den2)
+}
+
 /** Implementation of ex::normal() for a sum. It expands terms and performs
  *  fractional addition.
  *  @see ex::normal */
-ex add::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex add::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	if (level == 1)
 		return (new lst(replace_with_symbol(*this, repl, rev_lookup), _ex1))->setflag(status_flags::dynallocated);
@@ -2179,12 +2507,13 @@ ex add::normal(exmap & repl, exmap & rev_lookup, int level) const
 	dens.reserve(seq.size()+1);
 	epvector::const_iterator it = seq.begin(), itend = seq.end();
 	while (it != itend) {
-		ex n = ex_to<basic>(recombine_pair_to_ex(*it)).normal(repl, rev_lookup, level-1);
+		cancellation::poll("normal");
+		ex n = ex_to<basic>(recombine_pair_to_ex(*it)).normal(repl, rev_lookup, level-1, options);
 		nums.push_back(n.op(0));
 		dens.push_back(n.op(1));
 		it++;
 	}
-	ex n = ex_to<numeric>(overall_coeff).normal(repl, rev_lookup, level-1);
+	ex n = ex_to<numeric>(overall_coeff).normal(repl, rev_lookup, level-1, options);
 	nums.push_back(n.op(0));
 	dens.push_back(n.op(1));
 	GINAC_ASSERT(nums.size() == dens.size());
@@ -2193,12 +2522,42 @@ ex add::normal(exmap & repl, exmap & rev_lookup, int level) const
 	// all denominators
 //std::clog << "add::normal uses " << nums.size() << " summands:\n";
 
+	bool balanced = options & normal_options::balanced_sum;
+	if (!(options & (normal_options::sequential_sum | normal_options::balanced_sum)))
+		balanced = nums.size() >= balanced_sum_threshold;
+
+	if (balanced) {
+		// Add up the numerators of fractions with the same denominator
+		// first, then add the fractions with different denominators
+		exvector group_nums, group_dens;
+		std::map<ex, std::size_t, ex_is_less> group_index;
+		for (std::size_t i = 0; i < nums.size(); ++i) {
+			std::map<ex, std::size_t, ex_is_less>::const_iterator g = group_index.find(dens[i]);
+			if (g == group_index.end()) {
+				group_index.insert(std::make_pair(dens[i], group_nums.size()));
+				group_nums.push_back(nums[i]);
+				group_dens.push_back(dens[i]);
+			} else
+				group_nums[g->second] += nums[i];
+		}
+
+		const exvector vars = fraction_symbols(group_nums, group_dens);
+		frac_numerator num(vars);
+		ex den;
+		add_fractions_balanced(group_nums, group_dens, 0, group_nums.size(), num, den);
+		return frac_cancel(num.to_ex(), den);
+	}
+
 	// Add fractions sequentially
+	const exvector vars = fraction_symbols(nums, dens);
+	frac_numerator num(vars), next(vars);
 	exvector::const_iterator num_it = nums.begin(), num_itend = nums.end();
 	exvector::const_iterator den_it = dens.begin(), den_itend = dens.end();
 //std::clog << " num = " << *num_it << ", den = " << *den_it << std::endl;
-	ex num = *num_it++, den = *den_it++;
+	num.assign(*num_it++);
+	ex den = *den_it++;
 	while (num_it != num_itend) {
+		cancellation::poll("normal");
 //std::clog << " num = " << *num_it << ", den = " << *den_it << std::endl;
 		ex next_num = *num_it++, next_den = *den_it++;
 
@@ -2212,20 +2571,21 @@ ex add::normal(exmap & repl, exmap & rev_lookup, int level) const
 		// the heuristic GCD algorithm computes the cofactors at no extra cost
 		ex co_den1, co_den2;
 		ex g = gcd(den, next_den, &co_den1, &co_den2, false);
-		num = ((num * co_den2) + (next_num * co_den1)).expand();
+		next.assign(next_num);
+		num.mul_add(co_den2, next, co_den1);
 		den *= co_den2;		// this is the lcm(den, next_den)
 	}
 //std::clog << " common denominator = " << den << std::endl;
 
 	// Cancel common factors from num/den
-	return frac_cancel(num, den);
+	return frac_cancel(num.to_ex(), den);
 }
 
 
 /** Implementation of ex::normal() for a product. It cancels common factors
  *  from fractions.
  *  @see ex::normal() */
-ex mul::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex mul::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	if (level == 1)
 		return (new lst(replace_with_symbol(*this, repl, rev_lookup), _ex1))->setflag(status_flags::dynallocated);
@@ -2238,12 +2598,12 @@ ex mul::normal(exmap & repl, exmap & rev_lookup, int level) const
 	ex n;
 	epvector::const_iterator it = seq.begin(), itend = seq.end();
 	while (it != itend) {
-		n = ex_to<basic>(recombine_pair_to_ex(*it)).normal(repl, rev_lookup, level-1);
+		n = ex_to<basic>(recombine_pair_to_ex(*it)).normal(repl, rev_lookup, level-1, options);
 		num.push_back(n.op(0));
 		den.push_back(n.op(1));
 		it++;
 	}
-	n = ex_to<numeric>(overall_coeff).normal(repl, rev_lookup, level-1);
+	n = ex_to<numeric>(overall_coeff).normal(repl, rev_lookup, level-1, options);
 	num.push_back(n.op(0));
 	den.push_back(n.op(1));
 
@@ -2257,7 +2617,7 @@ ex mul::normal(exmap & repl, exmap & rev_lookup, int level) const
  *  distributes integer exponents to numerator and denominator, and replaces
  *  non-integer powers by temporary symbols.
  *  @see ex::normal */
-ex power::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex power::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	if (level == 1)
 		return (new lst(replace_with_symbol(*this, repl, rev_lookup), _ex1))->setflag(status_flags::dynallocated);
@@ -2265,8 +2625,8 @@ ex power::normal(exmap & repl, exmap & rev_lookup, int level) const
 		throw(std::runtime_error("max recursion level reached"));
 
 	// Normalize basis and exponent (exponent gets reassembled)
-	ex n_basis = ex_to<basic>(basis).normal(repl, rev_lookup, level-1);
-	ex n_exponent = ex_to<basic>(exponent).normal(repl, rev_lookup, level-1);
+	ex n_basis = ex_to<basic>(basis).normal(repl, rev_lookup, level-1, options);
+	ex n_exponent = ex_to<basic>(exponent).normal(repl, rev_lookup, level-1, options);
 	n_exponent = n_exponent.op(0) / n_exponent.op(1);
 
 	if (n_exponent.info(info_flags::integer)) {
@@ -2312,12 +2672,12 @@ ex power::normal(exmap & repl, exmap & rev_lookup, int level) const
 /** Implementation of ex::normal() for pseries. It normalizes each coefficient
  *  and replaces the series by a temporary symbol.
  *  @see ex::normal */
-ex pseries::normal(exmap & repl, exmap & rev_lookup, int level) const
+ex pseries::normal(exmap & repl, exmap & rev_lookup, int level, unsigned options) const
 {
 	epvector newseq;
 	epvector::const_iterator i = seq.begin(), end = seq.end();
 	while (i != end) {
-		ex restexp = i->rest.normal();
+		ex restexp = i->rest.normal(0, options);
 		if (!restexp.is_zero())
 			newseq.push_back(expair(restexp, i->coeff));
 		++i;
@@ -2338,12 +2698,16 @@ ex pseries::normal(exmap & repl, exmap & rev_lookup, int level) const
  *  recursively to arguments of functions etc.
  *
  *  @param level maximum depth of recursion
+ *  @param options see GiNaC::normal_options
  *  @return normalized expression */
-ex ex::normal(int level) const
+ex ex::normal(int level, unsigned options) const
 {
+	profile_scope prof(profiled_ops::normal);
 	exmap repl, rev_lookup;
 
-	ex e = bp->normal(repl, rev_lookup, level);
+	normal_gcd_cache_scope cache_scope(options);
+
+	ex e = bp->normal(repl, rev_lookup, level, options);
 	GINAC_ASSERT(is_a<lst>(e));
 
 	// Re-insert replaced symbols
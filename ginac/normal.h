@@ -28,6 +28,9 @@
 
 #include "lst.h"
 
+#include <cstddef>
+#include <iosfwd>
+
 namespace GiNaC {
 
 /**
@@ -58,7 +61,14 @@ struct gcd_options
 		 * it's much faster than PRS (pseudo remainder sequence)
 		 * algorithm. This flag forces GiNaC to use PRS algorithm
 		 */
-		use_sr_gcd = 8
+		use_sr_gcd = 8,
+		/**
+		 * Use Zippel's sparse modular GCD algorithm. GiNaC does this
+		 * by itself for sparse polynomials in many variables; this
+		 * flag forces it for any polynomials. If the algorithm fails,
+		 * the dense modular algorithm is used instead.
+		 */
+		use_sparse_gcd = 16
 
 	};
 };
@@ -88,6 +98,30 @@ extern bool divide(const ex &a, const ex &b, ex &q, bool check_args = true);
 extern ex gcd(const ex &a, const ex &b, ex *ca = NULL, ex *cb = NULL,
 	      bool check_args = true, unsigned options = 0);
 
+/** Cache of the results of gcd(), including the cofactors.  Rational
+ *  function arithmetic tends to compute the GCDs of the same denominators
+ *  over and over again; with the cache enabled, each pair of polynomials
+ *  (and set of gcd_options) is only handled once.  The cache is off by
+ *  default.  Alternatively, normal() can use a cache for the duration of
+ *  a single call, see normal_options::cache_gcd. */
+class gcd_cache {
+public:
+	/** Start caching GCDs.
+	 *  @param max_bytes approximate limit of the memory used by the
+	 *         cache, 0 means unlimited */
+	static void enable(std::size_t max_bytes = 0);
+	/** Stop caching GCDs and forget all cached results. */
+	static void disable();
+	static bool is_enabled();
+	/** Forget all cached results. */
+	static void clear();
+	/** Number of cached results. */
+	static std::size_t size();
+	/** Print the number of lookups and hits and an estimate of the
+	 *  time the cache saved. */
+	static void show_statistics(std::ostream & os);
+};
+
 // Polynomial LCM in Z[X]
 extern ex lcm(const ex &a, const ex &b, bool check_args = true);
 
@@ -919,6 +919,20 @@ const numeric numeric::power(const numeric &other) const
 
 
 
+/** Wrap the result of an arithmetic operation into a numeric object on the
+ *  heap, or return the shared object for it if it is a small integer. */
+static const numeric &dyn_result(const cln::cl_N & value)
+{
+	if (cln::instanceof(value, cln::cl_I_ring)) {
+		const cln::cl_I & i = cln::the<cln::cl_I>(value);
+		if (i >= -small_integer_max && i <= small_integer_max)
+			return *small_integer_numeric(cln::cl_I_to_long(i));
+	}
+	return static_cast<const numeric &>((new numeric(value))->
+	                                    setflag(status_flags::dynallocated));
+}
+
+
 /** Numerical addition method.  Adds argument to *this and returns result as
  *  a numeric object on the heap.  Use internally only for direct wrapping into
  *  an ex object, where the result would end up on the heap anyways. */
@@ -931,8 +945,7 @@ const numeric &numeric::add_dyn(const numeric &other) const
 	else if (&other==_num0_p)
 		return *this;
 	
-	return static_cast<const numeric &>((new numeric(value + other.value))->
-	                                    setflag(status_flags::dynallocated));
+	return dyn_result(value + other.value);
 }
 
 
@@ -947,8 +960,7 @@ const numeric &numeric::sub_dyn(const numeric &other) const
 	if (&other==_num0_p || cln::zerop(other.value))
 		return *this;
 	
-	return static_cast<const numeric &>((new numeric(value - other.value))->
-	                                    setflag(status_flags::dynallocated));
+	return dyn_result(value - other.value);
 }
 
 
@@ -965,8 +977,7 @@ const numeric &numeric::mul_dyn(const numeric &other) const
 	else if (&other==_num1_p)
 		return *this;
 	
-	return static_cast<const numeric &>((new numeric(value * other.value))->
-	                                    setflag(status_flags::dynallocated));
+	return dyn_result(value * other.value);
 }
 
 
@@ -984,8 +995,7 @@ const numeric &numeric::div_dyn(const numeric &other) const
 		return *this;
 	if (cln::zerop(cln::the<cln::cl_N>(other.value)))
 		throw std::overflow_error("division by zero");
-	return static_cast<const numeric &>((new numeric(value / other.value))->
-	                                    setflag(status_flags::dynallocated));
+	return dyn_result(value / other.value);
 }
 
 
@@ -1011,8 +1021,7 @@ const numeric &numeric::power_dyn(const numeric &other) const
 		else
 			return *_num0_p;
 	}
-	return static_cast<const numeric &>((new numeric(cln::expt(value, other.value)))->
-	                                     setflag(status_flags::dynallocated));
+	return dyn_result(cln::expt(value, other.value));
 }
 
 
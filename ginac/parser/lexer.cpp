@@ -30,29 +30,55 @@
 
 namespace GiNaC {
 
-/// Skip to the end of line
-static int skipline(std::istream* s);
-/// Skip to the next non-whitespace character
-static int skipspace(std::istream* s, int c, std::size_t& line);
 /// Check if the identifier is predefined literal
 static bool literal_p(const std::string& name);
 
+inline int lexer::next_char()
+{
+	if (buf) {
+		if (buf != buf_end)
+			return static_cast<unsigned char>(*buf++);
+		return EOF;
+	}
+	// Going through the stream buffer saves constructing a sentry
+	// for every single character.
+	int ch = input->rdbuf()->sbumpc();
+	if (ch == std::char_traits<char>::eof()) {
+		input->setstate(std::ios_base::eofbit);
+		return EOF;
+	}
+	return ch;
+}
+
 /// gettok - Return the next token from standard input.
 int lexer::gettok()
 {
 	// Skip any whitespace.
-	c = skipspace(input, c, line_num);
+	while (isspace(c)) {
+		if (c == '\n')
+			++line_num;
+		c = next_char();
+	}
 
 	// identifier: [a-zA-Z][a-zA-Z0-9_]*
 	if (isalpha(c)) { 
-		str = c;
-		do {
-			c = input->get();
-			if ( isalnum(c) || c=='_' )
-				str += c;
-			else
-				break;
-		} while (true);
+		if (buf) {
+			// the token is in the buffer already, copy it at once
+			const char* start = buf - 1;
+			do {
+				c = next_char();
+			} while (isalnum(c) || c=='_');
+			str.assign(start, c == EOF ? buf : buf - 1);
+		} else {
+			str = c;
+			do {
+				c = next_char();
+				if ( isalnum(c) || c=='_' )
+					str += c;
+				else
+					break;
+			} while (true);
+		}
 		if (unlikely(literal_p(str)))
 			return token_type::literal;
 		else
@@ -61,19 +87,19 @@ int lexer::gettok()
 
 	// Number: [0-9]+([.][0-9]*(eE[+-][0-9]+)*)*
 	if (isdigit(c) || c == '.') {
-		str = "";
+		str.clear();
 		do {
 			str += c;
-			c = input->get();
+			c = next_char();
 		} while (isdigit(c) || c == '.');
 		if (c == 'E' || c == 'e') {
 			str += 'E';
-			c = input->get();
+			c = next_char();
 			if (isdigit(c))
 				str += '+';
 			do {
 				str += c;
-				c = input->get();
+				c = next_char();
 			} while (isdigit(c));
 		}
 		return token_type::number;
@@ -81,7 +107,9 @@ int lexer::gettok()
 
 	// Comment until end of line.
 	if (c == '#') {
-		c = skipline(input);
+		do {
+			c = next_char();
+		} while (c != EOF && c != '\n' && c != '\r');
 		++line_num;
 		if (c != EOF)
 			return gettok();
@@ -93,29 +121,10 @@ int lexer::gettok()
 
 	// Otherwise, just return the character as its ascii value.
 	int current = c;
-	c = input->get();
+	c = next_char();
 	return current;
 }
 
-static int skipline(std::istream* s)
-{
-	int c;
-	do {
-		c = s->get();
-	} while (c != EOF && c != '\n' && c != '\r');
-	return c;
-}
-
-static int skipspace(std::istream* s, int c, std::size_t& line)
-{
-	while (isspace(c)) {
-		if (c == '\n')
-			++line;
-		c = s->get();
-	}
-	return c;
-}
-
 static bool literal_p(const std::string& name)
 {
 	if (name == "I")
@@ -147,6 +156,7 @@ lexer::lexer(std::istream* in, std::ostream* out, std::ostream* err)
 	else
 		error = &std::cerr;
 
+	buf = buf_end = 0;
 	c = ' ';
 	str = "";
 	line_num = 0;
@@ -158,6 +168,16 @@ lexer::~lexer() { }
 void lexer::switch_input(std::istream* in)
 {
 	input = in;
+	buf = buf_end = 0;
+	line_num = 0;
+	column = 0;
+	c = ' ';
+}
+
+void lexer::switch_input(const char* begin, const char* end)
+{
+	buf = begin;
+	buf_end = end;
 	line_num = 0;
 	column = 0;
 	c = ' ';
@@ -34,6 +34,9 @@ class lexer
 	std::istream* input;
 	std::ostream* output;
 	std::ostream* error;
+	/// input buffer (if reading from memory instead of a stream)
+	const char* buf;
+	const char* buf_end;
 	/// last character read from stream
 	int c;
 	/// identifier and number tokens are stored here
@@ -41,6 +44,9 @@ class lexer
 	std::size_t line_num;
 	std::size_t column;
 	friend class parser;
+
+	/// read the next character from the buffer or the stream
+	int next_char();
 public:
 
 	lexer(std::istream* in = 0, std::ostream* out = 0, std::ostream* err = 0);
@@ -48,6 +54,9 @@ public:
 
 	int gettok();
 	void switch_input(std::istream* in);
+	/// read from the characters in [begin, end), which must stay valid
+	/// while parsing
+	void switch_input(const char* begin, const char* end);
 
 	struct token_type
 	{
@@ -29,6 +29,7 @@
 #include "parser.h"
 #include "lexer.h"
 #include "debug.h"
+#include "utils.h"
 
 #include <sstream>
 #include <stdexcept>
@@ -37,6 +38,9 @@ namespace GiNaC {
 
 /// Make a sum or a product.
 static ex make_binop_expr(const int binop, const exvector& args);
+/// Make a sum or a product and add the already completed chunks of a sum.
+static ex make_chunked_binop_expr(const int binop, const exvector& args,
+                                  exvector& chunks);
 /// Check if the token is a binary operator. 
 static inline bool is_binop(const int c);
 /// Get the precedence of the pending binary operator.
@@ -47,13 +51,15 @@ ex parser::parse_binop_rhs(int expr_prec, ex& lhs)
 {
 	exvector args;
 	args.push_back(lhs);
+	// completed chunks of a long sum, see sum_chunk_size
+	exvector chunks;
 	int binop = -1, orig_binop = -1;
 	bool need_sign_flip = false;
 	while (1) {
 		// check if this is a binop
 		if (!is_binop(token)) {
-			if (args.size() > 1)
-				return make_binop_expr(orig_binop, args);
+			if (args.size() > 1 || !chunks.empty())
+				return make_chunked_binop_expr(orig_binop, args, chunks);
 			else
 				return lhs;
 		}
@@ -68,8 +74,8 @@ ex parser::parse_binop_rhs(int expr_prec, ex& lhs)
 		// the current binop, consume it, otherwise we are done.
 		int tok_prec = get_tok_prec(token);
 		if (tok_prec < expr_prec) {
-			if (args.size() > 1)
-				return make_binop_expr(orig_binop, args);
+			if (args.size() > 1 || !chunks.empty())
+				return make_chunked_binop_expr(orig_binop, args, chunks);
 			else 
 				return lhs;
 		}
@@ -96,21 +102,39 @@ ex parser::parse_binop_rhs(int expr_prec, ex& lhs)
 		// crucial for a reasonable performance. If the next operator
 		// is compatible with the pending one (or the same) don't create
 		// the expression and continue collecting operands instead.
+		bool more_terms = false;
 		if (binop == token)
-			continue;
+			more_terms = true;
 		else if (binop == '+' && token == '-') {
 			need_sign_flip = token != orig_binop;
-			continue;
+			more_terms = true;
 		} else if (binop == '-' && token == '+') {
 			need_sign_flip = token != orig_binop;
+			more_terms = true;
+		}
+
+		if (more_terms) {
+			// Sum of many terms: complete this chunk and start
+			// the next one with the pending operator, as if it
+			// were 0+... or 0-... (orig_binop is set to the same
+			// operator again in the next iteration, so the terms
+			// must not be flipped on top of that).
+			if (sum_chunk_size && args.size() >= sum_chunk_size &&
+			    (orig_binop == '+' || orig_binop == '-')) {
+				chunks.push_back(make_binop_expr(orig_binop, args));
+				args.clear();
+				args.push_back(_ex0);
+				orig_binop = token;
+				need_sign_flip = false;
+			}
 			continue;
-		} else { 
-			if (args.size() <= 1)
-				bug("binop has " << args.size() << " arguments, expected >= 2");
-			lhs = make_binop_expr(orig_binop, args);
-			args.clear();
-			args.push_back(lhs);
 		}
+
+		if (args.size() <= 1)
+			bug("binop has " << args.size() << " arguments, expected >= 2");
+		lhs = make_chunked_binop_expr(orig_binop, args, chunks);
+		args.clear();
+		args.push_back(lhs);
 	}
 }
 
@@ -137,6 +161,18 @@ static ex make_divide_expr(const exvector& args)
 	return (new mul(args[0], rest))->setflag(status_flags::dynallocated);
 }
 
+static ex make_chunked_binop_expr(const int binop, const exvector& args,
+                                  exvector& chunks)
+{
+	if (chunks.empty())
+		return make_binop_expr(binop, args);
+	// the chunks are merged into one flat sum at once
+	chunks.push_back(make_binop_expr(binop, args));
+	ex ret = (new add(chunks))->setflag(status_flags::dynallocated);
+	chunks.clear();
+	return ret;
+}
+
 static ex make_binop_expr(const int binop, const exvector& args)
 {
 	switch (binop) {
@@ -34,6 +34,7 @@
 #ifdef HAVE_STDINT_H
 #include <stdint.h> // for uintptr_t
 #endif
+#include <fstream>
 #include <sstream>
 #include <stdexcept>
 
@@ -76,7 +77,7 @@ ex parser::parse_identifier_expr()
 	get_next_tok();  // eat identifier.
 
 	if (token != '(') // symbol
-		return find_or_insert_symbol(name, syms, strict);
+		return lookup_symbol(name);
 
 	// function/ctor call.
 	get_next_tok();  // eat (
@@ -204,7 +205,17 @@ ex parser::parse_expression()
 /// number_expr: number
 ex parser::parse_number_expr()
 {
-	ex n = numeric(scanner->str.c_str());
+	// Small integers are by far the most common numbers, don't bother
+	// the general number parser with them
+	const std::string& str = scanner->str;
+	if (str.size() < 10 && str.find_first_not_of("0123456789") == std::string::npos) {
+		long value = 0;
+		for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+			value = value*10 + (*i - '0');
+		get_next_tok(); // consume the number
+		return value;
+	}
+	ex n = numeric(str.c_str());
 	get_next_tok(); // consume the number
 	return n;
 }
@@ -224,9 +235,24 @@ ex parser::parse_literal_expr()
 	bug("unknown literal: \"" << scanner->str << "\"");
 }
 
-ex parser::operator()(std::istream& input)
+ex parser::lookup_symbol(const std::string& name)
 {
-	scanner->switch_input(&input);
+	unsigned h = 0;
+	for (std::string::const_iterator i = name.begin(); i != name.end(); ++i)
+		h = h*31 + static_cast<unsigned char>(*i);
+	std::pair<std::string, ex>& entry = sym_cache[h & (sym_cache.size() - 1)];
+	if (entry.first != name) {
+		entry.second = find_or_insert_symbol(name, syms, strict);
+		entry.first = name;
+	}
+	return entry.second;
+}
+
+ex parser::parse_input()
+{
+	// the symbol table may have been changed since the last parse
+	sym_cache.assign(sym_cache.size(), std::make_pair(std::string(), ex()));
+
 	get_next_tok();
 	ex ret = parse_expression();
 	// parse_expression() stops if it encounters an unknown token.
@@ -239,11 +265,56 @@ ex parser::operator()(std::istream& input)
 	return ret;
 }
 
+ex parser::operator()(std::istream& input)
+{
+	scanner->switch_input(&input);
+	return parse_input();
+}
+
 ex parser::operator()(const std::string& input)
 {
-	std::istringstream is(input);
-	ex ret = operator()(is);
-	return ret;
+	return operator()(input.data(), input.data() + input.size());
+}
+
+ex parser::operator()(const char* begin, const char* end)
+{
+	scanner->switch_input(begin, end);
+	return parse_input();
+}
+
+ex parser::parse_file(const std::string& filename)
+{
+	std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!is)
+		throw std::runtime_error("parser::parse_file(): cannot open " + filename);
+
+	// Read the whole file at once and parse it from memory.  Files whose
+	// size cannot be determined (pipes, devices) are read in chunks.
+	std::vector<char> buffer;
+	std::streamoff size = -1;
+	if (is.seekg(0, std::ios::end))
+		size = is.tellg();
+	if (size >= 0 && is.seekg(0, std::ios::beg)) {
+		buffer.resize(size);
+		if (size > 0 && !is.read(&buffer[0], size))
+			throw std::runtime_error("parser::parse_file(): cannot read " + filename);
+	} else {
+		is.clear();
+		const std::size_t chunk_size = 65536;
+		std::size_t used = 0;
+		do {
+			buffer.resize(used + chunk_size);
+			is.read(&buffer[used], chunk_size);
+			used += is.gcount();
+		} while (is);
+		if (is.bad())
+			throw std::runtime_error("parser::parse_file(): cannot read " + filename);
+		buffer.resize(used);
+	}
+
+	if (buffer.empty())
+		return operator()(std::string());
+	return operator()(&buffer[0], &buffer[0] + buffer.size());
 }
 
 int parser::get_next_tok()
@@ -254,7 +325,7 @@ int parser::get_next_tok()
 
 parser::parser(const symtab& syms_, const bool strict_,
 	       const prototype_table& funcs_) : strict(strict_),
-	funcs(funcs_), syms(syms_)
+	sum_chunk_size(0), funcs(funcs_), syms(syms_), sym_cache(256)
 {
 	scanner = new lexer();
 }
@@ -26,7 +26,11 @@
 #include "parse_context.h"
 #include "ex.h"
 
+#include <cstddef>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace GiNaC {
 
@@ -95,6 +99,10 @@ public:
 	ex operator()(std::istream& input);
 	/// parse the string @a input
 	ex operator()(const std::string& input);
+	/// parse the characters in [@a begin, @a end)
+	ex operator()(const char* begin, const char* end);
+	/// parse the contents of the file @a filename
+	ex parse_file(const std::string& filename);
 
 	/// report the symbol table used by parser
 	symtab get_syms() const 
@@ -109,6 +117,13 @@ public:
 
 	/// If true, throw an exception if an unknown symbol is encountered.
 	bool strict;
+	/**
+	 * If non-zero, long sums are built in chunks of this many terms
+	 * which are merged at the end. Like terms are then combined while
+	 * parsing, which keeps the memory footprint of huge sums with many
+	 * repeated terms small. Zero (the default) builds every sum at once.
+	 */
+	std::size_t sum_chunk_size;
 private:
 	/**
 	 * Function/ctor table, maps a prototype (which is a name and number
@@ -130,6 +145,17 @@ private:
 	int token;
 	/// read the next token from the scanner
 	int get_next_tok();
+
+	/**
+	 * Recently looked up symbols, indexed by a hash of their names.
+	 * Saves most of the lookups in the symbol table for expressions
+	 * with many occurrences of the same symbols. Cleared before every
+	 * parse since the symbol table may be changed in between.
+	 */
+	std::vector<std::pair<std::string, ex> > sym_cache;
+	ex lookup_symbol(const std::string& name);
+	/// parse whatever the scanner has been switched to
+	ex parse_input();
 };
 
 } // namespace GiNaC
@@ -0,0 +1,215 @@
+/** @file pattern_set.cpp
+ *
+ *  Implementation of sets of patterns that are matched all at once. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "pattern_set.h"
+#include "expairseq.h"
+#include "numeric.h"
+#include "wildcard.h"
+
+namespace GiNaC {
+
+pattern_set::pattern_set(const lst & patterns)
+{
+	for (lst::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+		add(*it);
+}
+
+size_t pattern_set::add(const ex & pattern)
+{
+	entry en;
+	en.pattern = pattern;
+	en.literal = !haswild(pattern);
+	en.nops = pattern.nops();
+	en.global_wildcard = false;
+
+	if (is_a<expairseq>(pattern)) {
+		// Sums and products are matched regardless of the order of their
+		// terms, and a wildcard term matches all the terms left over (see
+		// expairseq::match())
+		for (size_t i=0; i<en.nops; i++) {
+			if (is_exactly_a<wildcard>(pattern.op(i))) {
+				en.global_wildcard = true;
+				break;
+			}
+		}
+	} else if (!en.literal) {
+		for (size_t i=0; i<en.nops; i++) {
+			const ex & o = pattern.op(i);
+			if (!haswild(o))
+				en.literal_ops.push_back(std::make_pair(i, o.gethash()));
+		}
+	}
+
+	entries.push_back(en);
+	buckets.clear();
+	return entries.size() - 1;
+}
+
+/** Get the patterns that can match an object at all.  Only wildcards and
+ *  patterns of the same type can match it (see basic::match() and
+ *  expairseq::match()), and the number of operands must be the same unless
+ *  the pattern is a sum or product with a wildcard term.  The result is
+ *  remembered for all objects of the same type and number of operands. */
+const pattern_set::bucket & pattern_set::candidates(const basic & e) const
+{
+	const std::type_info * ti = &typeid(e);
+	size_t num = e.nops();
+	std::pair<const std::type_info *, size_t> key(ti, num);
+	bucketmap::const_iterator found = buckets.find(key);
+	if (found != buckets.end())
+		return found->second;
+
+	bucket & b = buckets[key];
+	for (size_t i=0; i<entries.size(); i++) {
+		const entry & en = entries[i];
+		if (is_exactly_a<wildcard>(en.pattern)) {
+			b.general.push_back(i);
+			continue;
+		}
+		if (typeid(ex_to<basic>(en.pattern)) != *ti)
+			continue;
+		if (en.global_wildcard ? num + 1 < en.nops : num != en.nops)
+			continue;
+		if (en.literal)
+			b.literal[en.pattern.gethash()].push_back(i);
+		else
+			b.general.push_back(i);
+	}
+	return b;
+}
+
+/** Match an object against one pattern, rejecting it early if one of the
+ *  operands without wildcards does not have the right hash value. */
+bool pattern_set::try_entry(size_t i, const basic & e, exmap & repl_lst) const
+{
+	const entry & en = entries[i];
+	for (std::vector<std::pair<size_t, unsigned> >::const_iterator it = en.literal_ops.begin(); it != en.literal_ops.end(); ++it)
+		if (e.op(it->first).gethash() != it->second)
+			return false;
+
+	exmap tmp_repl = repl_lst;
+	if (!e.match(en.pattern, tmp_repl))
+		return false;
+	repl_lst.swap(tmp_repl);
+	return true;
+}
+
+bool pattern_set::match(const ex & e, exmap & repl_lst, size_t & which) const
+{
+	return match(ex_to<basic>(e), repl_lst, which);
+}
+
+bool pattern_set::match(const basic & e, exmap & repl_lst, size_t & which) const
+{
+	const bucket & b = candidates(e);
+
+	static const std::vector<size_t> none;
+	const std::vector<size_t> * literal = &none;
+	if (!b.literal.empty()) {
+		std::map<unsigned, std::vector<size_t> >::const_iterator found = b.literal.find(e.gethash());
+		if (found != b.literal.end())
+			literal = &found->second;
+	}
+
+	// Try the candidates in the order in which they were added
+	std::vector<size_t>::const_iterator g = b.general.begin(), gend = b.general.end();
+	std::vector<size_t>::const_iterator l = literal->begin(), lend = literal->end();
+	while (g != gend || l != lend) {
+		size_t i;
+		if (l == lend || (g != gend && *g < *l))
+			i = *g++;
+		else
+			i = *l++;
+		if (try_entry(i, e, repl_lst)) {
+			which = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Look for occurrences of the patterns in an expression.  If found is 0,
+ *  stop at the first occurrence, otherwise collect them like ex::find().
+ *  Subexpressions that are shared between several parts of the expression
+ *  are examined only once. */
+bool pattern_set::find_in(const ex & e, exset * found, std::map<const basic *, ex> & visited) const
+{
+	const basic & b = ex_to<basic>(e);
+	size_t num = b.nops();
+	bool shared = num > 0 && b.get_refcount() > 1;
+	if (shared && visited.find(&b) != visited.end())
+		return false;
+
+	if (!found && is_exactly_a<numeric>(e)) {
+		// numeric::has() also finds numbers with the opposite sign and the
+		// real and imaginary parts, but no wildcards
+		const bucket & bk = candidates(b);
+		for (std::map<unsigned, std::vector<size_t> >::const_iterator it = bk.literal.begin(); it != bk.literal.end(); ++it)
+			for (std::vector<size_t>::const_iterator i = it->second.begin(); i != it->second.end(); ++i)
+				if (b.has(entries[*i].pattern))
+					return true;
+		return false;
+	}
+
+	exmap repl_lst;
+	size_t which;
+	if (match(b, repl_lst, which)) {
+		if (found)
+			found->insert(e);
+		return true;
+	}
+
+	bool any_found = false;
+	for (size_t i=0; i<num; i++) {
+		if (find_in(b.op(i), found, visited)) {
+			if (!found)
+				return true;
+			any_found = true;
+		}
+	}
+
+	// Hold the object, so its address cannot be reused
+	if (shared)
+		visited.insert(std::make_pair(&b, e));
+	return any_found;
+}
+
+bool pattern_set::has(const ex & e, unsigned options) const
+{
+	if (options & has_options::algebraic) {
+		for (std::vector<entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+			if (e.has(it->pattern, options))
+				return true;
+		return false;
+	}
+
+	std::map<const basic *, ex> visited;
+	return find_in(e, 0, visited);
+}
+
+bool pattern_set::find(const ex & e, exset & found) const
+{
+	std::map<const basic *, ex> visited;
+	return find_in(e, &found, visited);
+}
+
+} // namespace GiNaC
@@ -0,0 +1,129 @@
+/** @file pattern_set.h
+ *
+ *  Interface to sets of patterns that are matched all at once. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_PATTERN_SET_H
+#define GINAC_PATTERN_SET_H
+
+#include "ex.h"
+#include "lst.h"
+
+#include <map>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace GiNaC {
+
+/** A set of patterns that an expression is matched against at once.  The
+ *  patterns are indexed by their type, their number of operands and the
+ *  hash values of their parts without wildcards.  Matching an expression
+ *  only tries those patterns which can match it at all, and an expression is
+ *  traversed only once when looking for occurrences of any of the patterns.
+ *  The patterns are tried in the order in which they were added.
+ *
+ *  Example:
+ *  @code
+ *  pattern_set rules(lst(sin(wild())*cos(wild()), pow(sin(wild()), 2)));
+ *  exmap repls;
+ *  size_t which;
+ *  if (e.match(rules, repls, which))
+ *      ...
+ *  @endcode */
+class pattern_set {
+public:
+	pattern_set() {}
+	explicit pattern_set(const lst & patterns);
+
+	/** Add a pattern and return its position in the set. */
+	size_t add(const ex & pattern);
+
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+	const ex & operator[](size_t i) const { return entries[i].pattern; }
+
+	/** Check whether an expression matches one of the patterns.  If so,
+	 *  the position of the first matching pattern is returned in "which"
+	 *  and the wildcard bindings are added to repl_lst. */
+	bool match(const ex & e, exmap & repl_lst, size_t & which) const;
+	bool match(const basic & e, exmap & repl_lst, size_t & which) const;
+
+	/** Check whether an expression or one of its subexpressions matches one
+	 *  of the patterns.  With has_options::algebraic, the patterns are
+	 *  checked one at a time with ex::has(). */
+	bool has(const ex & e, unsigned options = 0) const;
+
+	/** Find all occurrences of any of the patterns, like ex::find(). */
+	bool find(const ex & e, exset & found) const;
+
+private:
+	/** A pattern and what is known about it beforehand. */
+	struct entry {
+		ex pattern;
+		bool literal;           ///< pattern contains no wildcards
+		bool global_wildcard;   ///< sum or product with a wildcard term
+		size_t nops;
+		/** Operands without wildcards and their hash values, for patterns
+		 *  whose operands are matched one-to-one. */
+		std::vector<std::pair<size_t, unsigned> > literal_ops;
+	};
+
+	/** The patterns that can match objects of one type with a certain
+	 *  number of operands. */
+	struct bucket {
+		std::vector<size_t> general;                       ///< patterns with wildcards
+		std::map<unsigned, std::vector<size_t> > literal;  ///< patterns without, by hash value
+	};
+
+	/** Order on (type, number of operands) pairs. */
+	struct bucket_key_less {
+		bool operator()(const std::pair<const std::type_info *, size_t> & a,
+		                const std::pair<const std::type_info *, size_t> & b) const
+		{
+			if (a.first != b.first && *a.first != *b.first)
+				return a.first->before(*b.first) != 0;
+			return a.second < b.second;
+		}
+	};
+	typedef std::map<std::pair<const std::type_info *, size_t>, bucket, bucket_key_less> bucketmap;
+
+	const bucket & candidates(const basic & e) const;
+	bool try_entry(size_t i, const basic & e, exmap & repl_lst) const;
+	bool find_in(const ex & e, exset * found, std::map<const basic *, ex> & visited) const;
+
+	std::vector<entry> entries;
+	mutable bucketmap buckets;  ///< built on demand
+};
+
+// wrapper functions around member functions
+
+inline bool match(const ex & e, const pattern_set & patterns, exmap & repl_lst, size_t & which)
+{ return patterns.match(e, repl_lst, which); }
+
+inline bool has(const ex & e, const pattern_set & patterns, unsigned options = 0)
+{ return patterns.has(e, options); }
+
+inline bool find(const ex & e, const pattern_set & patterns, exset & found)
+{ return patterns.find(e, found); }
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_PATTERN_SET_H
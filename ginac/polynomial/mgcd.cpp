@@ -27,6 +27,8 @@
 #include "primes_factory.h"
 #include "divide_in_z_p.h"
 #include "poly_cra.h"
+#include "cancellation.h"
+#include "profiler.h"
 #include <numeric> // std::accumulate
 
 #include <cln/integer.h>
@@ -60,6 +62,7 @@ static cln::cl_I extract_integer_content(ex& Apr, const ex& A)
 
 ex chinrem_gcd(const ex& A_, const ex& B_, const exvector& vars)
 {
+	profile_scope prof(profiled_ops::chinrem_gcd);
 	ex A, B;
 	const cln::cl_I a_icont = extract_integer_content(A, A_);
 	const cln::cl_I b_icont = extract_integer_content(B, B_);
@@ -85,6 +88,7 @@ ex chinrem_gcd(const ex& A_, const ex& B_, const exvector& vars)
 	long p;
 	primes_factory pfactory;
 	while (true) {
+		cancellation::poll("gcd");
 		bool has_primes = pfactory(p, g_lc);
 		if (!has_primes)
 			throw chinrem_gcd_failed();
@@ -0,0 +1,241 @@
+/** @file mpoly.cpp
+ *
+ *  Sparse multivariate polynomials with integer coefficients. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "mpoly.h"
+#include "add.h"
+#include "mul.h"
+#include "numeric.h"
+#include "power.h"
+#include "symbol.h"
+#include "debug.h"
+
+#include <cln/integer.h>
+#include <map>
+
+namespace GiNaC {
+
+/// Order of the exponent vectors, the same as in collect_vargs()
+struct exp_vector_less
+{
+	inline bool operator()(const exp_vector_t& v1, const exp_vector_t& v2) const
+	{
+		return v1 < v2;
+	}
+};
+
+typedef std::map<exp_vector_t, cln::cl_I, exp_vector_less> mpoly_map;
+
+static void mpoly_from_map(mpoly& p, const mpoly_map& m)
+{
+	p.clear();
+	p.reserve(m.size());
+	for (mpoly_map::const_iterator i = m.begin(); i != m.end(); ++i) {
+		if (!zerop(i->second))
+			p.push_back(*i);
+	}
+}
+
+static void add_term(mpoly_map& m, const exp_vector_t& e, const cln::cl_I& c)
+{
+	std::pair<mpoly_map::iterator, bool> ins = m.insert(std::make_pair(e, c));
+	if (!ins.second)
+		ins.first->second = ins.first->second + c;
+}
+
+static int var_index(const ex& e, const exvector& vars)
+{
+	for (std::size_t i = 0; i < vars.size(); ++i) {
+		if (vars[i].is_equal(e))
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * If e is a single term c*x_0^k_0*...*x_{n-1}^k_{n-1}, store its
+ * exponent vector and coefficient.
+ */
+static bool monomial_to_term(const ex& e, const exvector& vars,
+                             exp_vector_t& exps, cln::cl_I& c)
+{
+	if (is_exactly_a<numeric>(e)) {
+		if (!e.info(info_flags::integer))
+			return false;
+		c = c * cln::the<cln::cl_I>(ex_to<numeric>(e).to_cl_N());
+		return true;
+	}
+	if (is_a<symbol>(e)) {
+		const int i = var_index(e, vars);
+		if (i < 0)
+			return false;
+		++exps[i];
+		return true;
+	}
+	if (is_exactly_a<power>(e)) {
+		const ex& exponent = e.op(1);
+		if (!is_a<symbol>(e.op(0)) || !exponent.info(info_flags::posint))
+			return false;
+		const int i = var_index(e.op(0), vars);
+		if (i < 0)
+			return false;
+		exps[i] += ex_to<numeric>(exponent).to_int();
+		return true;
+	}
+	if (is_exactly_a<mul>(e)) {
+		for (std::size_t i = 0; i < e.nops(); ++i) {
+			if (!monomial_to_term(e.op(i), vars, exps, c))
+				return false;
+		}
+		return true;
+	}
+	return false;
+}
+
+bool ex_to_mpoly(mpoly& p, const ex& e, const exvector& vars)
+{
+	p.clear();
+
+	// Fast path for (sums of) monomials, i.e. expanded polynomials
+	exp_vector_t exps(vars.size());
+	cln::cl_I c = 1;
+	if (monomial_to_term(e, vars, exps, c)) {
+		if (!zerop(c))
+			p.push_back(std::make_pair(exps, c));
+		return true;
+	}
+
+	if (is_exactly_a<add>(e)) {
+		mpoly_map m;
+		for (std::size_t i = 0; i < e.nops(); ++i) {
+			exp_vector_t term_exps(vars.size());
+			cln::cl_I term_c = 1;
+			if (monomial_to_term(e.op(i), vars, term_exps, term_c)) {
+				add_term(m, term_exps, term_c);
+				continue;
+			}
+			mpoly q;
+			if (!ex_to_mpoly(q, e.op(i), vars))
+				return false;
+			for (mpoly::const_iterator j = q.begin(); j != q.end(); ++j)
+				add_term(m, j->first, j->second);
+		}
+		mpoly_from_map(p, m);
+		return true;
+	}
+
+	if (is_exactly_a<mul>(e)) {
+		mpoly q, r;
+		p.push_back(std::make_pair(exp_vector_t(vars.size()), cln::cl_I(1)));
+		for (std::size_t i = 0; i < e.nops(); ++i) {
+			if (!ex_to_mpoly(q, e.op(i), vars))
+				return false;
+			mpoly_mul(r, p, q);
+			p.swap(r);
+		}
+		return true;
+	}
+
+	if (is_exactly_a<power>(e)) {
+		if (!e.op(1).info(info_flags::posint))
+			return false;
+		mpoly base, r;
+		if (!ex_to_mpoly(base, e.op(0), vars))
+			return false;
+		// binary powering
+		p.push_back(std::make_pair(exp_vector_t(vars.size()), cln::cl_I(1)));
+		for (long n = ex_to<numeric>(e.op(1)).to_long(); n != 0; n >>= 1) {
+			if (n & 1) {
+				mpoly_mul(r, p, base);
+				p.swap(r);
+			}
+			if (n > 1) {
+				mpoly_mul(r, base, base);
+				base.swap(r);
+			}
+		}
+		return true;
+	}
+
+	return false;
+}
+
+ex mpoly_to_ex(const mpoly& p, const exvector& vars)
+{
+	exvector ev;
+	ev.reserve(p.size());
+	for (mpoly::const_iterator i = p.begin(); i != p.end(); ++i) {
+		bug_on(i->first.size() != vars.size(),
+			"expected " << vars.size() << " variables, "
+			"polynomial has " << i->first.size() << " instead");
+		exvector tv;
+		tv.reserve(vars.size() + 1);
+		for (std::size_t j = 0; j < vars.size(); ++j) {
+			if (i->first[j] != 0)
+				tv.push_back(power(vars[j], i->first[j]));
+		}
+		tv.push_back(numeric(i->second));
+		ev.push_back((new mul(tv))->setflag(status_flags::dynallocated));
+	}
+	return (new add(ev))->setflag(status_flags::dynallocated);
+}
+
+void mpoly_add(mpoly& r, const mpoly& a, const mpoly& b)
+{
+	r.clear();
+	r.reserve(a.size() + b.size());
+	mpoly::const_iterator i = a.begin(), j = b.begin();
+	while (i != a.end() && j != b.end()) {
+		if (i->first < j->first)
+			r.push_back(*i++);
+		else if (j->first < i->first)
+			r.push_back(*j++);
+		else {
+			const cln::cl_I c = i->second + j->second;
+			if (!zerop(c))
+				r.push_back(std::make_pair(i->first, c));
+			++i;
+			++j;
+		}
+	}
+	r.insert(r.end(), i, a.end());
+	r.insert(r.end(), j, b.end());
+}
+
+void mpoly_mul(mpoly& r, const mpoly& a, const mpoly& b)
+{
+	r.clear();
+	if (a.empty() || b.empty())
+		return;
+
+	mpoly_map m;
+	exp_vector_t exps(a.begin()->first.size());
+	for (mpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		for (mpoly::const_iterator j = b.begin(); j != b.end(); ++j) {
+			for (std::size_t k = 0; k < exps.size(); ++k)
+				exps[k] = i->first[k] + j->first[k];
+			add_term(m, exps, i->second * j->second);
+		}
+	}
+	mpoly_from_map(r, m);
+}
+
+} // namespace GiNaC
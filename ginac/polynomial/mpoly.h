@@ -0,0 +1,69 @@
+/** @file mpoly.h
+ *
+ *  Sparse multivariate polynomials with integer coefficients, used for
+ *  adding up the numerators of sums in add::normal() and inside
+ *  zippel_gcd(). */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_MPOLY_H
+#define GINAC_MPOLY_H
+
+#include "ex.h"
+#include "collect_vargs.h"
+
+#include <cln/integer.h>
+#include <utility>
+#include <vector>
+
+namespace GiNaC {
+
+/**
+ * Polynomial in the variables x_0, \ldots, x_{n-1} with integer
+ * coefficients, stored as the list of its non-zero terms (exponent
+ * vector, coefficient), sorted by exponent vector in the same order as
+ * collect_vargs() uses. All polynomials taking part in an operation must
+ * refer to the same list of variables.
+ *
+ * Only conversion, addition and multiplication are provided.  normal()
+ * uses mpoly for accumulating the numerators of sums only; GCDs,
+ * divisions and the final cancellation are still done on expressions
+ * by gcd(), divide() and frac_cancel().
+ */
+typedef std::vector<std::pair<exp_vector_t, cln::cl_I> > mpoly;
+
+/**
+ * Convert the polynomial e in the variables vars into an mpoly. e need
+ * not be expanded.
+ * @return false if e is not a polynomial in vars with integer coefficients
+ */
+extern bool ex_to_mpoly(mpoly& p, const ex& e, const exvector& vars);
+
+/// Convert the polynomial p back into an (expanded) expression.
+extern ex mpoly_to_ex(const mpoly& p, const exvector& vars);
+
+/// r = a + b
+extern void mpoly_add(mpoly& r, const mpoly& a, const mpoly& b);
+
+/// r = a * b
+extern void mpoly_mul(mpoly& r, const mpoly& a, const mpoly& b);
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_MPOLY_H
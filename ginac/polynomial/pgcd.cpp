@@ -27,6 +27,7 @@
 #include "eval_point_finder.h"
 #include "newton_interpolate.h"
 #include "divide_in_z_p.h"
+#include "cancellation.h"
 
 namespace GiNaC {
 
@@ -87,6 +88,7 @@ ex pgcd(const ex& A, const ex& B, const exvector& vars, const long p)
 	eval_point_finder find_eval_point(p);
 	const numeric pn(p);
 	do {
+		cancellation::poll("gcd");
 		// Find a `good' evaluation point b.
 		bool has_more_pts = find_eval_point(b, lc_gcd, mainvar);
 		// If there are no more possible evaluation points, bail out
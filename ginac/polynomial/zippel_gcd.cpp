@@ -0,0 +1,918 @@
+/** @file zippel_gcd.cpp
+ *
+ *  Sparse modular GCD algorithm (Zippel). */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "zippel_gcd.h"
+#include "mpoly.h"
+#include "collect_vargs.h"
+#include "divide_in_z_p.h"
+#include "primes_factory.h"
+#include "add.h"
+#include "numeric.h"
+#include "operators.h"
+#include "cancellation.h"
+#include "profiler.h"
+#include "debug.h"
+
+#include <algorithm>
+#include <cln/integer.h>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace GiNaC {
+
+namespace {
+
+/// Order of the exponent vectors, the same as in collect_vargs()
+struct exp_less
+{
+	inline bool operator()(const exp_vector_t& v1, const exp_vector_t& v2) const
+	{
+		return v1 < v2;
+	}
+};
+
+/// Arithmetic in Z_p, for primes p < 2^30 (so that sums fit into a long)
+class zp_field
+{
+public:
+	explicit zp_field(long p_) : p(p_) { }
+
+	long add(long a, long b) const
+	{
+		const long s = a + b;
+		return s >= p ? s - p : s;
+	}
+	long sub(long a, long b) const
+	{
+		return a >= b ? a - b : a - b + p;
+	}
+	long neg(long a) const
+	{
+		return a ? p - a : 0;
+	}
+	long mul(long a, long b) const
+	{
+		return static_cast<long>((static_cast<unsigned long long>(a) *
+		                          static_cast<unsigned long long>(b)) %
+		                         static_cast<unsigned long long>(p));
+	}
+	long inv(long a) const
+	{
+		long r0 = p, r1 = a, t0 = 0, t1 = 1;
+		while (r1 != 0) {
+			const long q = r0 / r1;
+			long tmp = r0 - q*r1;
+			r0 = r1;
+			r1 = tmp;
+			tmp = t0 - q*t1;
+			t0 = t1;
+			t1 = tmp;
+		}
+		bug_on(r0 != 1, "no inverse of " << a << " modulo " << p);
+		return t0 < 0 ? t0 + p : t0;
+	}
+	long pow(long a, long e) const
+	{
+		long r = 1;
+		for (; e != 0; e >>= 1) {
+			if (e & 1)
+				r = mul(r, a);
+			a = mul(a, a);
+		}
+		return r;
+	}
+	long reduce(const cln::cl_I& c) const
+	{
+		return cln::cl_I_to_long(cln::mod(c, cln::cl_I(p)));
+	}
+	long random() const
+	{
+		return cln::cl_I_to_long(cln::random_I(cln::cl_I(p)));
+	}
+	long random_nonzero() const
+	{
+		return 1 + cln::cl_I_to_long(cln::random_I(cln::cl_I(p - 1)));
+	}
+
+	const long p;
+};
+
+/// Multivariate polynomial over Z_p, terms sorted like in mpoly
+typedef std::vector<std::pair<exp_vector_t, long> > zpoly;
+typedef std::map<exp_vector_t, long, exp_less> zpoly_map;
+/// Univariate polynomial over Z_p, dense, without leading zeros
+typedef std::vector<long> uzpoly;
+/// Polynomial in x_0, ..., x_{k-1} with coefficients in Z_p[x_k]
+typedef std::map<exp_vector_t, uzpoly, exp_less> kpoly;
+
+/// Maximal number of unknowns in the linear systems of sparse interpolation
+const std::size_t max_sparse_unknowns = 500;
+/// Maximal number of primes to try
+const unsigned max_primes = 128;
+
+//////////
+// univariate polynomials over Z_p
+//////////
+
+int uz_degree(const uzpoly& a)
+{
+	return static_cast<int>(a.size()) - 1;
+}
+
+void uz_trim(uzpoly& a)
+{
+	while (!a.empty() && a.back() == 0)
+		a.pop_back();
+}
+
+long uz_eval(const uzpoly& a, long x, const zp_field& F)
+{
+	long r = 0;
+	for (std::size_t i = a.size(); i-- != 0; )
+		r = F.add(F.mul(r, x), a[i]);
+	return r;
+}
+
+void uz_make_monic(uzpoly& a, const zp_field& F)
+{
+	if (a.empty() || a.back() == 1)
+		return;
+	const long c = F.inv(a.back());
+	for (std::size_t i = 0; i < a.size(); ++i)
+		a[i] = F.mul(a[i], c);
+}
+
+/// r = r mod b
+void uz_rem(uzpoly& r, const uzpoly& b, const zp_field& F)
+{
+	bug_on(b.empty(), "division by zero polynomial");
+	const long binv = F.inv(b.back());
+	while (r.size() >= b.size()) {
+		const long q = F.mul(r.back(), binv);
+		const std::size_t shift = r.size() - b.size();
+		for (std::size_t i = 0; i < b.size(); ++i)
+			r[i + shift] = F.sub(r[i + shift], F.mul(q, b[i]));
+		r.pop_back();
+		uz_trim(r);
+	}
+}
+
+/// Exact division q = a/b, returns false if b does not divide a
+bool uz_divide(uzpoly& q, const uzpoly& a, const uzpoly& b, const zp_field& F)
+{
+	bug_on(b.empty(), "division by zero polynomial");
+	q.clear();
+	if (a.size() < b.size())
+		return a.empty();
+	uzpoly r = a;
+	q.resize(a.size() - b.size() + 1);
+	const long binv = F.inv(b.back());
+	while (r.size() >= b.size()) {
+		const long c = F.mul(r.back(), binv);
+		const std::size_t shift = r.size() - b.size();
+		q[shift] = c;
+		for (std::size_t i = 0; i < b.size(); ++i)
+			r[i + shift] = F.sub(r[i + shift], F.mul(c, b[i]));
+		r.pop_back();
+		uz_trim(r);
+	}
+	return r.empty();
+}
+
+/// Monic GCD
+uzpoly uz_gcd(uzpoly a, uzpoly b, const zp_field& F)
+{
+	uz_trim(a);
+	uz_trim(b);
+	while (!b.empty()) {
+		uz_rem(a, b, F);
+		a.swap(b);
+	}
+	uz_make_monic(a, F);
+	return a;
+}
+
+//////////
+// multivariate polynomials over Z_p
+//////////
+
+void add_term(zpoly_map& m, const exp_vector_t& e, long c, const zp_field& F)
+{
+	if (c == 0)
+		return;
+	std::pair<zpoly_map::iterator, bool> ins = m.insert(std::make_pair(e, c));
+	if (!ins.second) {
+		ins.first->second = F.add(ins.first->second, c);
+		if (ins.first->second == 0)
+			m.erase(ins.first);
+	}
+}
+
+void from_map(zpoly& a, const zpoly_map& m)
+{
+	a.clear();
+	a.reserve(m.size());
+	for (zpoly_map::const_iterator i = m.begin(); i != m.end(); ++i) {
+		if (i->second != 0)
+			a.push_back(*i);
+	}
+}
+
+bool is_constant(const zpoly& a)
+{
+	return a.size() == 1 && zerop(a[0].first);
+}
+
+int degree_in(const zpoly& a, std::size_t var)
+{
+	int d = -1;
+	for (zpoly::const_iterator i = a.begin(); i != a.end(); ++i)
+		d = std::max(d, i->first[var]);
+	return d;
+}
+
+void make_monic(zpoly& a, const zp_field& F)
+{
+	if (a.empty() || a.back().second == 1)
+		return;
+	const long c = F.inv(a.back().second);
+	for (zpoly::iterator i = a.begin(); i != a.end(); ++i)
+		i->second = F.mul(i->second, c);
+}
+
+zpoly reduce(const mpoly& a, const zp_field& F)
+{
+	zpoly r;
+	r.reserve(a.size());
+	for (mpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		const long c = F.reduce(i->second);
+		if (c != 0)
+			r.push_back(std::make_pair(i->first, c));
+	}
+	return r;
+}
+
+zpoly zp_mul(const zpoly& a, const zpoly& b, const zp_field& F)
+{
+	zpoly_map m;
+	for (zpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		for (zpoly::const_iterator j = b.begin(); j != b.end(); ++j) {
+			exp_vector_t e = i->first;
+			for (std::size_t k = 0; k < e.size(); ++k)
+				e[k] += j->first[k];
+			add_term(m, e, F.mul(i->second, j->second), F);
+		}
+	}
+	zpoly r;
+	from_map(r, m);
+	return r;
+}
+
+/// Exact division q = a/b, returns false if b does not divide a
+bool zp_divide(zpoly& q, const zpoly& a, const zpoly& b, const zp_field& F)
+{
+	q.clear();
+	if (b.empty())
+		return false;
+	zpoly_map r(a.begin(), a.end());
+	zpoly_map qm;
+	const exp_vector_t& blm = b.back().first;
+	const long binv = F.inv(b.back().second);
+	exp_vector_t e(blm.size()), f(blm.size());
+	while (!r.empty()) {
+		zpoly_map::iterator lt = r.end();
+		--lt;
+		for (std::size_t v = 0; v < e.size(); ++v) {
+			e[v] = lt->first[v] - blm[v];
+			if (e[v] < 0)
+				return false;
+		}
+		const long c = F.mul(lt->second, binv);
+		qm[e] = c;
+		for (zpoly::const_iterator t = b.begin(); t != b.end(); ++t) {
+			for (std::size_t v = 0; v < f.size(); ++v)
+				f[v] = e[v] + t->first[v];
+			add_term(r, f, F.neg(F.mul(c, t->second)), F);
+		}
+	}
+	from_map(q, qm);
+	return true;
+}
+
+/// Substitute x_var = val
+zpoly eval(const zpoly& a, std::size_t var, long val, const zp_field& F)
+{
+	zpoly_map m;
+	for (zpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		exp_vector_t e = i->first;
+		const long c = F.mul(i->second, F.pow(val, e[var]));
+		e[var] = 0;
+		add_term(m, e, c, F);
+	}
+	zpoly r;
+	from_map(r, m);
+	return r;
+}
+
+/// Substitute x_v = point[v] for all variables v except keep
+uzpoly eval_to_uz(const zpoly& a, std::size_t keep, const std::vector<long>& point,
+                  const zp_field& F)
+{
+	uzpoly r;
+	for (zpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		long c = i->second;
+		for (std::size_t v = 0; v < point.size(); ++v) {
+			if (v != keep && i->first[v] != 0)
+				c = F.mul(c, F.pow(point[v], i->first[v]));
+		}
+		const std::size_t d = i->first[keep];
+		if (r.size() <= d)
+			r.resize(d + 1, 0);
+		r[d] = F.add(r[d], c);
+	}
+	uz_trim(r);
+	return r;
+}
+
+/// Value of the monomial with exponents e at point (x_0 is left out)
+long monomial_value(const exp_vector_t& e, const std::vector<long>& point, const zp_field& F)
+{
+	long r = 1;
+	for (std::size_t v = 1; v < e.size(); ++v) {
+		if (e[v] != 0)
+			r = F.mul(r, F.pow(point[v], e[v]));
+	}
+	return r;
+}
+
+zpoly from_uz(const uzpoly& u, std::size_t var, std::size_t nvars)
+{
+	zpoly r;
+	exp_vector_t e(nvars);
+	for (std::size_t d = 0; d < u.size(); ++d) {
+		if (u[d] != 0) {
+			e[var] = d;
+			r.push_back(std::make_pair(e, u[d]));
+		}
+	}
+	return r;
+}
+
+kpoly to_kpoly(const zpoly& a, std::size_t k)
+{
+	kpoly r;
+	for (zpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		exp_vector_t e = i->first;
+		const std::size_t d = e[k];
+		e[k] = 0;
+		uzpoly& c = r[e];
+		if (c.size() <= d)
+			c.resize(d + 1, 0);
+		c[d] = i->second;
+	}
+	return r;
+}
+
+zpoly from_kpoly(const kpoly& a, std::size_t k)
+{
+	zpoly_map m;
+	for (kpoly::const_iterator i = a.begin(); i != a.end(); ++i) {
+		exp_vector_t e = i->first;
+		for (std::size_t d = 0; d < i->second.size(); ++d) {
+			if (i->second[d] != 0) {
+				e[k] = d;
+				m.insert(std::make_pair(e, i->second[d]));
+			}
+		}
+	}
+	zpoly r;
+	from_map(r, m);
+	return r;
+}
+
+int kpoly_degree(const kpoly& a)
+{
+	int d = -1;
+	for (kpoly::const_iterator i = a.begin(); i != a.end(); ++i)
+		d = std::max(d, uz_degree(i->second));
+	return d;
+}
+
+/// GCD of the coefficients, which are polynomials in x_k
+uzpoly kpoly_content(const kpoly& a, const zp_field& F)
+{
+	kpoly::const_iterator i = a.begin();
+	uzpoly g = i->second;
+	uz_make_monic(g, F);
+	for (++i; i != a.end() && g.size() > 1; ++i)
+		g = uz_gcd(g, i->second, F);
+	return g;
+}
+
+void kpoly_divide(kpoly& a, const uzpoly& c, const zp_field& F)
+{
+	if (c.size() == 1 && c[0] == 1)
+		return;
+	uzpoly q;
+	for (kpoly::iterator i = a.begin(); i != a.end(); ++i) {
+		const bool divisible = uz_divide(q, i->second, c, F);
+		bug_on(!divisible, "content does not divide the coefficients");
+		i->second.swap(q);
+	}
+}
+
+/**
+ * Newton interpolation in x_k: add the image S = H(x_k = alpha) to H,
+ * where newton is the product of (x_k - a) over the previous points a.
+ */
+void newton_update(kpoly& H, uzpoly& newton, const zpoly& S, long alpha, const zp_field& F)
+{
+	const long ninv = F.inv(uz_eval(newton, alpha, F));
+	for (zpoly::const_iterator i = S.begin(); i != S.end(); ++i)
+		H.insert(std::make_pair(i->first, uzpoly()));
+	const zpoly_map s(S.begin(), S.end());
+
+	kpoly::iterator i = H.begin();
+	while (i != H.end()) {
+		zpoly_map::const_iterator j = s.find(i->first);
+		const long value = j != s.end() ? j->second : 0;
+		const long c = F.mul(F.sub(value, uz_eval(i->second, alpha, F)), ninv);
+		if (c != 0) {
+			uzpoly& h = i->second;
+			if (h.size() < newton.size())
+				h.resize(newton.size(), 0);
+			for (std::size_t d = 0; d < newton.size(); ++d)
+				h[d] = F.add(h[d], F.mul(c, newton[d]));
+			uz_trim(h);
+		}
+		if (i->second.empty())
+			H.erase(i++);
+		else
+			++i;
+	}
+
+	// newton *= x_k - alpha
+	newton.push_back(0);
+	for (std::size_t d = newton.size() - 1; d != 0; --d)
+		newton[d] = F.sub(newton[d - 1], F.mul(alpha, newton[d]));
+	newton[0] = F.neg(F.mul(alpha, newton[0]));
+}
+
+/**
+ * Solve the linear system given by the augmented matrix rows over Z_p.
+ * Returns false unless the system has exactly one solution.
+ */
+bool solve(std::vector<std::vector<long> >& rows, std::size_t ncols,
+           std::vector<long>& sol, const zp_field& F)
+{
+	std::size_t rank = 0;
+	for (std::size_t col = 0; col < ncols; ++col) {
+		std::size_t pivot = rank;
+		while (pivot < rows.size() && rows[pivot][col] == 0)
+			++pivot;
+		if (pivot == rows.size())
+			return false;
+		rows[pivot].swap(rows[rank]);
+		std::vector<long>& prow = rows[rank];
+		const long c = F.inv(prow[col]);
+		for (std::size_t k = col; k <= ncols; ++k)
+			prow[k] = F.mul(prow[k], c);
+		for (std::size_t r = 0; r < rows.size(); ++r) {
+			if (r == rank || rows[r][col] == 0)
+				continue;
+			const long f = rows[r][col];
+			for (std::size_t k = col; k <= ncols; ++k)
+				rows[r][k] = F.sub(rows[r][k], F.mul(f, prow[k]));
+		}
+		++rank;
+	}
+	// The remaining equations must be satisfied as well
+	for (std::size_t r = rank; r < rows.size(); ++r) {
+		if (rows[r][ncols] != 0)
+			return false;
+	}
+	sol.resize(ncols);
+	for (std::size_t col = 0; col < ncols; ++col)
+		sol[col] = rows[col][ncols];
+	return true;
+}
+
+/**
+ * Sparse interpolation: compute the monic GCD S of A, B in
+ * Z_p[x_0, ..., x_m], assuming that it has the same terms as skel.
+ * Each univariate image S(x_0, b_1, ..., b_m) is known up to a factor
+ * only, so these factors are unknowns of the linear system as well as
+ * the coefficients of S.
+ * @return false if the assumption turns out to be wrong or the linear
+ *         system is not suitable
+ */
+bool sparse_interpolate(zpoly& S, const zpoly& A, const zpoly& B, const zpoly& skel,
+                        std::size_t m, const zp_field& F)
+{
+	if (m == 0 || skel.empty())
+		return false;
+	const std::size_t T = skel.size();
+	const std::size_t lead = T - 1;
+
+	// Terms of the skeleton by degree in x_0
+	std::map<int, std::vector<std::size_t> > groups;
+	for (std::size_t t = 0; t < T; ++t)
+		groups[skel[t].first[0]].push_back(t);
+	const std::size_t J = groups.size();
+	if (J < 2)
+		return false;
+	const int deg0 = groups.rbegin()->first;
+
+	// Unknowns: the coefficients except the leading one (which is 1) and
+	// one factor per image. This many images give a few more equations
+	// than unknowns.
+	const std::size_t nimages = T / (J - 1) + 1;
+	const std::size_t ncols = (T - 1) + nimages;
+	if (ncols > max_sparse_unknowns)
+		return false;
+
+	const int degA = degree_in(A, 0), degB = degree_in(B, 0);
+	std::vector<long> point(A[0].first.size(), 0);
+	std::vector<std::vector<long> > rows;
+	rows.reserve(nimages * J);
+	for (std::size_t i = 0; i < nimages; ++i) {
+		uzpoly a, b;
+		unsigned attempts = 0;
+		do {
+			if (++attempts > 10)
+				return false;
+			for (std::size_t v = 1; v <= m; ++v)
+				point[v] = F.random_nonzero();
+			a = eval_to_uz(A, 0, point, F);
+			b = eval_to_uz(B, 0, point, F);
+		} while (uz_degree(a) != degA || uz_degree(b) != degB);
+
+		const uzpoly u = uz_gcd(a, b, F);
+		if (uz_degree(u) != deg0)
+			return false;
+		for (int j = 0; j <= deg0; ++j) {
+			if (u[j] != 0 && groups.find(j) == groups.end())
+				return false;
+		}
+
+		for (std::map<int, std::vector<std::size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g) {
+			std::vector<long> row(ncols + 1, 0);
+			for (std::vector<std::size_t>::const_iterator t = g->second.begin(); t != g->second.end(); ++t) {
+				const long mt = monomial_value(skel[*t].first, point, F);
+				if (*t == lead)
+					row[ncols] = F.neg(mt);
+				else
+					row[*t] = mt;
+			}
+			row[lead + i] = F.neg(u[g->first]);
+			rows.push_back(row);
+		}
+	}
+
+	std::vector<long> sol;
+	if (!solve(rows, ncols, sol, F))
+		return false;
+	for (std::size_t i = 0; i < nimages; ++i) {
+		if (sol[lead + i] == 0)
+			return false;
+	}
+
+	S.clear();
+	for (std::size_t t = 0; t < lead; ++t) {
+		if (sol[t] != 0)
+			S.push_back(std::make_pair(skel[t].first, sol[t]));
+	}
+	S.push_back(std::make_pair(skel[lead].first, 1L));
+	return true;
+}
+
+/**
+ * Monic GCD of A and B in Z_p[x_0, ..., x_k]. The GCD is interpolated in
+ * x_k from images at x_k = alpha, which are computed recursively for the
+ * first point and by sparse interpolation afterwards.
+ */
+zpoly zp_gcd(const zpoly& A, const zpoly& B, std::size_t k, const zp_field& F)
+{
+	if (A.empty() || B.empty()) {
+		zpoly r = A.empty() ? B : A;
+		make_monic(r, F);
+		return r;
+	}
+	const std::size_t nvars = A[0].first.size();
+
+	if (k == 0) {
+		const std::vector<long> dummy(nvars, 0);
+		return from_uz(uz_gcd(eval_to_uz(A, 0, dummy, F), eval_to_uz(B, 0, dummy, F), F), 0, nvars);
+	}
+
+	// Primitive parts and contents w.r.t. x_0, ..., x_{k-1}
+	kpoly kA = to_kpoly(A, k), kB = to_kpoly(B, k);
+	const uzpoly contA = kpoly_content(kA, F), contB = kpoly_content(kB, F);
+	kpoly_divide(kA, contA, F);
+	kpoly_divide(kB, contB, F);
+	const uzpoly cont_gcd = uz_gcd(contA, contB, F);
+
+	// The leading coefficient of the GCD divides gamma
+	const uzpoly& lcA = kA.rbegin()->second;
+	const uzpoly& lcB = kB.rbegin()->second;
+	const uzpoly gamma = uz_gcd(lcA, lcB, F);
+
+	const zpoly Ap = from_kpoly(kA, k), Bp = from_kpoly(kB, k);
+	const int D = std::min(kpoly_degree(kA), kpoly_degree(kB)) + uz_degree(gamma);
+
+	kpoly H;
+	uzpoly newton(1, 1);
+	zpoly skeleton;
+	exp_vector_t lm;
+	int npoints = 0;
+	std::set<long> used;
+	const unsigned max_tries = 10*(D + 1) + 50;
+	for (unsigned tries = 0; tries < max_tries && used.size() < std::size_t(F.p); ++tries) {
+		cancellation::poll("gcd");
+		const long alpha = F.random();
+		if (!used.insert(alpha).second)
+			continue;
+		if (uz_eval(lcA, alpha, F) == 0 || uz_eval(lcB, alpha, F) == 0)
+			continue;
+
+		const zpoly Aa = eval(Ap, k, alpha, F), Ba = eval(Bp, k, alpha, F);
+		zpoly S;
+		if (!sparse_interpolate(S, Aa, Ba, skeleton, k - 1, F))
+			S = zp_gcd(Aa, Ba, k - 1, F);
+		if (is_constant(S)) {
+			// The primitive parts are coprime
+			zpoly r = from_uz(cont_gcd, k, nvars);
+			make_monic(r, F);
+			return r;
+		}
+
+		const exp_vector_t& slm = S.back().first;
+		if (npoints == 0 || slm < lm) {
+			// First image, or all previous images were unlucky
+			H.clear();
+			newton = uzpoly(1, 1);
+			npoints = 0;
+			lm = slm;
+		} else if (lm < slm) {
+			// This image is unlucky
+			continue;
+		}
+		skeleton = S;
+
+		// Scale the image so that its leading coefficient is gamma(alpha)
+		const long ga = uz_eval(gamma, alpha, F);
+		for (zpoly::iterator i = S.begin(); i != S.end(); ++i)
+			i->second = F.mul(i->second, ga);
+		newton_update(H, newton, S, alpha, F);
+		if (++npoints <= D)
+			continue;
+
+		kpoly G = H;
+		kpoly_divide(G, kpoly_content(G, F), F);
+		zpoly g = from_kpoly(G, k), q;
+		if (zp_divide(q, Ap, g, F) && zp_divide(q, Bp, g, F)) {
+			g = zp_mul(g, from_uz(cont_gcd, k, nvars), F);
+			make_monic(g, F);
+			return g;
+		}
+
+		// Some image was wrong after all, start over
+		npoints = 0;
+		skeleton.clear();
+	}
+	throw zippel_gcd_failed();
+}
+
+/**
+ * Upper bounds of the degrees of the GCD of A and B in each variable, from
+ * univariate images.
+ */
+exp_vector_t degree_bounds(const zpoly& A, const zpoly& B, const zp_field& F)
+{
+	const std::size_t nvars = A[0].first.size();
+	exp_vector_t bounds(nvars);
+	std::vector<long> point(nvars);
+	for (std::size_t v = 0; v < nvars; ++v) {
+		const int degA = degree_in(A, v), degB = degree_in(B, v);
+		bounds[v] = std::min(degA, degB);
+		for (unsigned attempts = 0; attempts < 10; ++attempts) {
+			for (std::size_t w = 0; w < nvars; ++w)
+				point[w] = F.random_nonzero();
+			const uzpoly a = eval_to_uz(A, v, point, F), b = eval_to_uz(B, v, point, F);
+			if (uz_degree(a) == degA && uz_degree(b) == degB) {
+				bounds[v] = uz_degree(uz_gcd(a, b, F));
+				break;
+			}
+		}
+	}
+	return bounds;
+}
+
+/**
+ * Find a fraction num/den with |num|, |den| <= sqrt(m/2) which is
+ * congruent to u modulo m.
+ */
+bool rational_reconstruction(cln::cl_I& num, cln::cl_I& den, const cln::cl_I& u, const cln::cl_I& m)
+{
+	cln::cl_I bound;
+	cln::isqrt(m >> 1, &bound);
+	cln::cl_I r0 = m, r1 = cln::mod(u, m), t0 = 0, t1 = 1;
+	while (r1 > bound) {
+		const cln::cl_I q = cln::floor1(r0, r1);
+		cln::cl_I tmp = r0 - q*r1;
+		r0 = r1;
+		r1 = tmp;
+		tmp = t0 - q*t1;
+		t0 = t1;
+		t1 = tmp;
+	}
+	if (zerop(t1) || cln::abs(t1) > bound || cln::gcd(r1, t1) != 1)
+		return false;
+	if (minusp(t1)) {
+		num = -r1;
+		den = -t1;
+	} else {
+		num = r1;
+		den = t1;
+	}
+	return true;
+}
+
+typedef std::map<exp_vector_t, cln::cl_I, exp_less> coeff_map;
+
+/**
+ * Reconstruct the rational coefficients of the monic GCD from their
+ * images modulo q, and make the result primitive over Z.
+ */
+bool reconstruct(mpoly& G, const coeff_map& H, const cln::cl_I& q)
+{
+	std::vector<std::pair<exp_vector_t, std::pair<cln::cl_I, cln::cl_I> > > fracs;
+	cln::cl_I L = 1;
+	for (coeff_map::const_iterator i = H.begin(); i != H.end(); ++i) {
+		if (zerop(i->second))
+			continue;
+		cln::cl_I num, den;
+		if (!rational_reconstruction(num, den, i->second, q))
+			return false;
+		L = cln::lcm(L, den);
+		fracs.push_back(std::make_pair(i->first, std::make_pair(num, den)));
+	}
+
+	G.clear();
+	G.reserve(fracs.size());
+	cln::cl_I cont = 0;
+	for (std::size_t i = 0; i < fracs.size(); ++i) {
+		const cln::cl_I c = fracs[i].second.first * cln::exquo(L, fracs[i].second.second);
+		cont = cln::gcd(cont, c);
+		G.push_back(std::make_pair(fracs[i].first, c));
+	}
+	if (G.empty())
+		return false;
+	for (mpoly::iterator i = G.begin(); i != G.end(); ++i)
+		i->second = cln::exquo(i->second, cont);
+	return true;
+}
+
+/** Remove the integer content of e, return the content if it is an integer. */
+cln::cl_I extract_integer_content(ex& pp, const ex& e)
+{
+	const numeric icont = e.integer_content();
+	pp = (e/icont).expand();
+	if (icont.is_integer())
+		return cln::the<cln::cl_I>(icont.to_cl_N());
+	// Polynomial over the rationals, GCD is defined up to a rational
+	// number only
+	return cln::cl_I(1);
+}
+
+std::size_t nterms(const ex& e)
+{
+	return is_exactly_a<add>(e) ? e.nops() : 1;
+}
+
+} // anonymous namespace
+
+ex zippel_gcd(const ex& A_, const ex& B_, const exvector& vars)
+{
+	profile_scope prof(profiled_ops::zippel_gcd);
+	ex Aex, Bex;
+	const cln::cl_I c = cln::gcd(extract_integer_content(Aex, A_),
+	                             extract_integer_content(Bex, B_));
+	mpoly A, B;
+	if (vars.empty() || !ex_to_mpoly(A, Aex, vars) || !ex_to_mpoly(B, Bex, vars) ||
+	    A.empty() || B.empty())
+		throw zippel_gcd_failed();
+	const std::size_t nvars = vars.size();
+
+	// Primes must not divide the leading coefficients
+	const cln::cl_I lc_prod = A.back().second * B.back().second;
+
+	exp_vector_t bounds;
+	coeff_map H;
+	cln::cl_I q = 0;
+	exp_vector_t lm;
+	zpoly skeleton;
+	primes_factory pfactory;
+	long p;
+	for (unsigned nprimes = 0; nprimes < max_primes; ++nprimes) {
+		cancellation::poll("gcd");
+		if (!pfactory(p, lc_prod) || p >= (1L << 30))
+			break;
+		const zp_field F(p);
+		const zpoly Ap = reduce(A, F), Bp = reduce(B, F);
+		if (bounds.empty())
+			bounds = degree_bounds(Ap, Bp, F);
+
+		// After the first prime, the terms of the GCD are known
+		zpoly Gp;
+		if (!sparse_interpolate(Gp, Ap, Bp, skeleton, nvars - 1, F))
+			Gp = zp_gcd(Ap, Bp, nvars - 1, F);
+		if (is_constant(Gp))
+			return numeric(c);
+
+		const exp_vector_t& glm = Gp.back().first;
+		if (zerop(q) || glm < lm) {
+			// First image, or all previous primes were unlucky
+			H.clear();
+			for (zpoly::const_iterator i = Gp.begin(); i != Gp.end(); ++i)
+				H.insert(std::make_pair(i->first, cln::cl_I(i->second)));
+			q = p;
+			lm = glm;
+		} else if (lm < glm) {
+			// Unlucky prime
+			continue;
+		} else {
+			// Chinese remaindering
+			const long qinv = F.inv(F.reduce(q));
+			for (zpoly::const_iterator i = Gp.begin(); i != Gp.end(); ++i)
+				H.insert(std::make_pair(i->first, cln::cl_I(0)));
+			const zpoly_map g(Gp.begin(), Gp.end());
+			for (coeff_map::iterator i = H.begin(); i != H.end(); ++i) {
+				zpoly_map::const_iterator j = g.find(i->first);
+				const long u2 = j != g.end() ? j->second : 0;
+				const long t = F.mul(F.sub(u2, F.reduce(i->second)), qinv);
+				i->second = i->second + q*t;
+			}
+			q = q*p;
+		}
+		skeleton = Gp;
+
+		mpoly G;
+		if (!reconstruct(G, H, q))
+			continue;
+		const ex Gex = mpoly_to_ex(G, vars);
+
+		// A divisor of both polynomials which is at least of the degree
+		// of the GCD in every variable is the GCD.
+		bool ok = true;
+		for (std::size_t v = 0; v < nvars && ok; ++v)
+			ok = Gex.degree(vars[v]) >= bounds[v];
+		ex dummy;
+		if (ok && divide_in_z_p(Aex, Gex, dummy, vars, 0) &&
+		          divide_in_z_p(Bex, Gex, dummy, vars, 0))
+			return (numeric(c)*Gex).expand();
+
+		// Maybe the terms were wrong, recompute them with the next prime
+		skeleton.clear();
+	}
+	throw zippel_gcd_failed();
+}
+
+bool zippel_gcd_is_suitable(const ex& A, const ex& B, const exvector& vars)
+{
+	if (vars.size() < 4)
+		return false;
+
+	// Compare the number of terms with the number of terms a dense
+	// polynomial of the same degrees would have
+	double denseA = 1, denseB = 1;
+	for (std::size_t v = 0; v < vars.size(); ++v) {
+		denseA *= A.degree(vars[v]) + 1;
+		denseB *= B.degree(vars[v]) + 1;
+	}
+	return nterms(A) * 10 < denseA && nterms(B) * 10 < denseB;
+}
+
+} // namespace GiNaC
@@ -0,0 +1,63 @@
+/** @file zippel_gcd.h
+ *
+ *  Interface to the sparse modular GCD algorithm. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_ZIPPEL_GCD_H
+#define GINAC_ZIPPEL_GCD_H
+
+#include "ex.h"
+
+namespace GiNaC {
+
+/**
+ * GCD of two multivariate polynomials with integer coefficients using
+ * Zippel's sparse modular algorithm. The GCD modulo a prime is obtained
+ * by interpolating one variable at a time; after the first image in
+ * each variable, further images are computed by sparse interpolation
+ * from the terms of that first image, which needs only univariate GCDs.
+ * The images for different primes are combined by Chinese remaindering
+ * and rational reconstruction.
+ *
+ * The result is checked by trial division and against degree bounds,
+ * so it is never wrong; if the algorithm fails to find it, an exception
+ * of type zippel_gcd_failed is thrown.
+ *
+ * @param A first polynomial, must have integer coefficients
+ * @param B second polynomial, must have integer coefficients
+ * @param vars all variables occurring in A and B. The first one is
+ *        treated densely, so it should be the one with the highest degree.
+ */
+extern ex zippel_gcd(const ex& A, const ex& B, const exvector& vars);
+
+/**
+ * Check whether A and B are sparse enough in enough variables that
+ * zippel_gcd() is likely to be faster than the dense algorithms.
+ */
+extern bool zippel_gcd_is_suitable(const ex& A, const ex& B, const exvector& vars);
+
+struct zippel_gcd_failed
+{
+	virtual ~zippel_gcd_failed() { }
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_ZIPPEL_GCD_H
@@ -21,6 +21,7 @@
  */
 
 #include "power.h"
+#include "cancellation.h"
 #include "expairseq.h"
 #include "add.h"
 #include "mul.h"
@@ -372,6 +373,7 @@ ex power::coeff(const ex & s, int n) const
  *  @param level cut-off in recursive evaluation */
 ex power::eval(int level) const
 {
+	profiler::count(profiled_ops::power_eval);
 	if ((level==1) && (flags & status_flags::evaluated))
 		return *this;
 	else if (level == -max_recursion_level)
@@ -888,6 +890,7 @@ ex power::expand_add(const add & a, int n, unsigned options) const
 	}
 
 	while (true) {
+		cancellation::poll("expand");
 		exvector term;
 		term.reserve(m+1);
 		for (std::size_t l = 0; l < m - 1; ++l) {
@@ -968,6 +971,7 @@ ex power::expand_add_2(const add & a, unsigned options) const
 	// power(+(x,...,z;c),2)=power(+(x,...,z;0),2)+2*c*+(x,...,z;0)+c*c
 	// first part: ignore overall_coeff and expand other terms
 	for (epvector::const_iterator cit0=a.seq.begin(); cit0!=last; ++cit0) {
+		cancellation::poll("expand");
 		const ex & r = cit0->rest;
 		const ex & c = cit0->coeff;
 		
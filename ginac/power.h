@@ -65,7 +65,7 @@ public:
 	ex series(const relational & s, int order, unsigned options = 0) const;
 	ex subs(const exmap & m, unsigned options = 0) const;
 	bool has(const ex & other, unsigned options = 0) const;
-	ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const;
+	ex normal(exmap & repl, exmap & rev_lookup, int level = 0, unsigned options = 0) const;
 	ex to_rational(exmap & repl) const;
 	ex to_polynomial(exmap & repl) const;
 	ex conjugate() const;
@@ -0,0 +1,237 @@
+/** @file prepared_subs.cpp
+ *
+ *  Implementation of repeated substitution of values for a fixed set of
+ *  symbols. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "prepared_subs.h"
+#include "numeric.h"
+#include "power.h"
+#include "pseries.h"
+#include "symbol.h"
+
+#include <stdexcept>
+
+namespace GiNaC {
+
+prepared_subs::prepared_subs(const ex & e_, const lst & syms_) : e(e_), syms(syms_), evalf_digits(0)
+{
+	int n = 0;
+	for (lst::const_iterator it = syms.begin(); it != syms.end(); ++it, ++n) {
+		if (!is_a<symbol>(*it))
+			throw std::invalid_argument("prepared_subs::prepared_subs(): can only substitute for symbols");
+		sym_index[*it] = n;
+	}
+
+	std::map<const basic *, int> done;
+	exvector keep;
+	analyze(e, done, keep);
+
+	// power::evalf() leaves numeric exponents exact, so exponents that
+	// depend on the symbols are rebuilt exactly by evalf() as well, like
+	// everything below them (parents come after their operands)
+	for (size_t n=deps.size(); n-- > 0; ) {
+		dependent & d = deps[n];
+		for (std::vector<std::pair<size_t, size_t> >::const_iterator it = d.ops.begin(); it != d.ops.end(); ++it)
+			if (d.exact || (is_exactly_a<power>(d.e) && it->first == 1))
+				deps[it->second].exact = true;
+	}
+}
+
+/** Record all subexpressions of x which depend on the symbols, operands
+ *  before the expressions containing them.
+ *
+ *  @param x  expression to analyze
+ *  @param done  indices of the dependents already found (or -1 for an
+ *               expression that doesn't depend on the symbols), by address
+ *  @param keep  holds the expressions in done which are not recorded as
+ *               dependents, so their addresses stay valid
+ *  @return index of x in deps, or -1 if x doesn't depend on the symbols */
+int prepared_subs::analyze(const ex & x, std::map<const basic *, int> & done, exvector & keep)
+{
+	const basic * key = &ex_to<basic>(x);
+	std::map<const basic *, int>::const_iterator found = done.find(key);
+	if (found != done.end())
+		return found->second;
+
+	dependent d;
+	d.e = x;
+	d.symbol = -1;
+	d.opaque = false;
+	d.exact = false;
+
+	std::map<ex, int, ex_is_less>::const_iterator si = sym_index.find(x);
+	if (si != sym_index.end()) {
+		d.symbol = si->second;
+	} else if (is_a<pseries>(x)) {
+		// Series have operands, but can't be reassembled from them
+		for (lst::const_iterator it = syms.begin(); !d.opaque && it != syms.end(); ++it)
+			d.opaque = x.has(*it);
+	} else {
+		for (size_t i=0; i<x.nops(); ++i) {
+			int n = analyze(x.op(i), done, keep);
+			if (n >= 0)
+				d.ops.push_back(std::make_pair(i, size_t(n)));
+		}
+	}
+
+	if (d.symbol < 0 && !d.opaque && d.ops.empty()) {
+		keep.push_back(x);
+		done[key] = -1;
+		return -1;
+	}
+
+	deps.push_back(d);
+	done[key] = deps.size() - 1;
+	return deps.size() - 1;
+}
+
+namespace {
+
+/** Replaces the operands of one dependent subexpression by the new values
+ *  of the operands.  This relies on map() calling the function for the
+ *  operands in the order of op(). */
+struct replace_operands : public map_function {
+	const std::vector<std::pair<size_t, size_t> > & ops;
+	const exvector & results;
+	const exvector * numeric_ops;
+	size_t i, next;
+
+	replace_operands(const std::vector<std::pair<size_t, size_t> > & ops_, const exvector & results_, const exvector * numeric_ops_)
+	 : ops(ops_), results(results_), numeric_ops(numeric_ops_), i(0), next(0) {}
+
+	ex operator()(const ex & x)
+	{
+		ex r;
+		if (next < ops.size() && ops[next].first == i)
+			r = results[ops[next++].second];
+		else if (numeric_ops)
+			r = (*numeric_ops)[i];
+		else
+			r = x;
+		++i;
+		return r;
+	}
+};
+
+} // anonymous namespace
+
+ex prepared_subs::rebuild(const exvector & values, bool evaluate) const
+{
+	if (values.size() != syms.nops())
+		throw std::invalid_argument("prepared_subs: number of values doesn't match number of symbols");
+
+	if (deps.empty())
+		return evaluate ? e.evalf() : e;
+
+	// Evaluate the operands which don't depend on the symbols numerically,
+	// once for every precision
+	if (evaluate && evalf_digits != long(Digits)) {
+		evalf_ops.clear();
+		evalf_ops.resize(deps.size());
+		for (size_t n=0; n<deps.size(); ++n) {
+			const dependent & d = deps[n];
+			if (d.symbol >= 0 || d.opaque || d.exact)
+				continue;
+			exvector & v = evalf_ops[n];
+			v.resize(d.e.nops());
+			std::vector<std::pair<size_t, size_t> >::const_iterator dop = d.ops.begin();
+			for (size_t i=0; i<v.size(); ++i) {
+				if (dop != d.ops.end() && dop->first == i)
+					++dop;
+				else if (i == 1 && is_exactly_a<power>(d.e) && is_exactly_a<numeric>(d.e.op(1)))
+					v[i] = d.e.op(1);  // like power::evalf()
+				else
+					v[i] = d.e.op(i).evalf();
+			}
+		}
+		evalf_digits = Digits;
+	}
+
+	exmap m;
+	for (size_t i=0; i<values.size(); ++i)
+		m[syms.op(i)] = values[i];
+
+	exvector results(deps.size());
+	for (size_t n=0; n<deps.size(); ++n) {
+		const dependent & d = deps[n];
+		ex r;
+		if (d.symbol >= 0) {
+			r = values[d.symbol];
+		} else if (d.opaque) {
+			r = d.e.subs(m, subs_options::no_pattern);
+		} else {
+			replace_operands f(d.ops, results, evaluate && !d.exact ? &evalf_ops[n] : 0);
+			r = d.e.map(f);
+
+			// Like subs(), substitute again if the rebuilt expression happens
+			// to be one of the symbols
+			if (is_a<symbol>(r)) {
+				exmap::const_iterator it = m.find(r);
+				if (it != m.end())
+					r = it->second;
+			}
+		}
+		results[n] = evaluate && !d.exact ? r.evalf() : r;
+	}
+
+	// The whole expression is the last one recorded
+	return results.back();
+}
+
+ex prepared_subs::subs(const exvector & values) const
+{
+	return rebuild(values, false);
+}
+
+ex prepared_subs::subs(const lst & values) const
+{
+	return rebuild(exvector(values.begin(), values.end()), false);
+}
+
+ex prepared_subs::evalf(const exvector & values) const
+{
+	return rebuild(values, true);
+}
+
+ex prepared_subs::evalf(const lst & values) const
+{
+	return rebuild(exvector(values.begin(), values.end()), true);
+}
+
+exvector prepared_subs::subs(const std::vector<exvector> & points) const
+{
+	exvector results;
+	results.reserve(points.size());
+	for (std::vector<exvector>::const_iterator it = points.begin(); it != points.end(); ++it)
+		results.push_back(rebuild(*it, false));
+	return results;
+}
+
+exvector prepared_subs::evalf(const std::vector<exvector> & points) const
+{
+	exvector results;
+	results.reserve(points.size());
+	for (std::vector<exvector>::const_iterator it = points.begin(); it != points.end(); ++it)
+		results.push_back(rebuild(*it, true));
+	return results;
+}
+
+} // namespace GiNaC
@@ -0,0 +1,106 @@
+/** @file prepared_subs.h
+ *
+ *  Interface to repeated substitution of values for a fixed set of symbols. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_PREPARED_SUBS_H
+#define GINAC_PREPARED_SUBS_H
+
+#include "ex.h"
+#include "lst.h"
+
+#include <map>
+#include <vector>
+
+namespace GiNaC {
+
+/** Substitution of many different sets of values for the same symbols into
+ *  one expression.  The expression is analyzed once: all subexpressions that
+ *  contain one of the symbols are recorded, in an order such that every one
+ *  comes after its operands.  Substituting a set of values then only rebuilds
+ *  those subexpressions, one level at a time, while all subexpressions that do
+ *  not depend on the symbols are reused as they are.  Subexpressions that are
+ *  shared between several parts of the expression are rebuilt only once.
+ *
+ *  The result is the same as the one of ex::subs() with the option
+ *  subs_options::no_pattern and a map from the symbols to the values.
+ *
+ *  Example:
+ *  @code
+ *  prepared_subs ps(e, lst(x, y));
+ *  for (...)
+ *      result = ps.evalf(lst(xval, yval));
+ *  @endcode */
+class prepared_subs {
+public:
+	/** Analyze expression for substitutions of values for the given list of
+	 *  symbols. */
+	prepared_subs(const ex & e, const lst & syms);
+
+	/** Substitute values (in the order of the symbols given to the
+	 *  constructor) and return the result. */
+	ex subs(const exvector & values) const;
+	ex subs(const lst & values) const;
+
+	/** Substitute values and evaluate the result numerically.  Parts of the
+	 *  expression which do not depend on the symbols are evaluated
+	 *  numerically only once (per setting of Digits). */
+	ex evalf(const exvector & values) const;
+	ex evalf(const lst & values) const;
+
+	/** Substitute many sets of values, one result per set. */
+	exvector subs(const std::vector<exvector> & points) const;
+	exvector evalf(const std::vector<exvector> & points) const;
+
+	/** Get the expression the substitutions are performed in. */
+	ex get_expression() const { return e; }
+
+	/** Get the number of subexpressions that need to be rebuilt for every
+	 *  substitution. */
+	size_t nodes() const { return deps.size(); }
+
+private:
+	/** A subexpression that depends on the symbols. */
+	struct dependent {
+		ex e;             ///< the original subexpression
+		int symbol;       ///< index of the symbol if e is one of the symbols, -1 otherwise
+		bool opaque;      ///< e can't be rebuilt from its operands, use ex::subs()
+		bool exact;       ///< e is (part of) an exponent, evalf() rebuilds it exactly
+		std::vector<std::pair<size_t, size_t> > ops; ///< (operand number, index of dependent) pairs
+	};
+
+	int analyze(const ex & x, std::map<const basic *, int> & done, exvector & keep);
+	ex rebuild(const exvector & values, bool evaluate) const;
+
+	ex e;
+	lst syms;
+	std::map<ex, int, ex_is_less> sym_index; ///< symbol -> its position in syms
+	std::vector<dependent> deps;   ///< dependent subexpressions, operands first
+
+	/** Numerically evaluated operands of the dependent subexpressions (null
+	 *  for the operands that depend on the symbols themselves), for the
+	 *  precision stored in evalf_digits. */
+	mutable std::vector<exvector> evalf_ops;
+	mutable long evalf_digits;
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_PREPARED_SUBS_H
@@ -0,0 +1,142 @@
+/** @file profiler.cpp
+ *
+ *  Implementation of the runtime profiling of expensive operations. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "profiler.h"
+
+#include <iomanip>
+#include <ostream>
+
+namespace GiNaC {
+
+bool profiler::enabled = false;
+unsigned long profiler::objects_created = 0;
+profiler::counters profiler::data[profiled_ops::num_ops];
+
+namespace {
+
+const char * const op_names[profiled_ops::num_ops] = {
+	"expand",
+	"add::eval",
+	"mul::eval",
+	"power::eval",
+	"compare",
+	"subs",
+	"normal",
+	"series",
+	"gcd",
+	"heur_gcd",
+	"sr_gcd",
+	"chinrem_gcd",
+	"zippel_gcd",
+	"factor",
+	"factor_univariate",
+	"factor_multivariate",
+	"hensel_univar",
+	"hensel_multivar"
+};
+
+/** Whether time and objects are recorded for the operation. */
+bool is_timed(unsigned op)
+{
+	return op != profiled_ops::add_eval && op != profiled_ops::mul_eval &&
+	       op != profiled_ops::power_eval && op != profiled_ops::compare;
+}
+
+} // anonymous namespace
+
+void profiler::reset()
+{
+	// Leave the depths alone, operations may be running
+	for (unsigned op = 0; op < profiled_ops::num_ops; ++op) {
+		data[op].calls = 0;
+		data[op].objects = 0;
+		data[op].ticks = 0;
+	}
+}
+
+const char * profiler::name(unsigned op)
+{
+	return op < profiled_ops::num_ops ? op_names[op] : "unknown";
+}
+
+void profiler::print(std::ostream & os)
+{
+	// The formatting must not stay in effect for the caller's output
+	const std::ios::fmtflags flags = os.flags();
+	const std::streamsize precision = os.precision();
+
+	os << std::left << std::setw(20) << "operation"
+	   << std::right << std::setw(12) << "calls"
+	   << std::setw(12) << "seconds"
+	   << std::setw(14) << "objects" << std::endl;
+	for (unsigned op = 0; op < profiled_ops::num_ops; ++op) {
+		if (data[op].calls == 0)
+			continue;
+		os << std::left << std::setw(20) << op_names[op]
+		   << std::right << std::setw(12) << data[op].calls;
+		if (is_timed(op)) {
+			os << std::setw(12) << std::fixed << std::setprecision(3) << seconds(op)
+			   << std::setw(14) << data[op].objects;
+		} else
+			os << std::setw(12) << "-" << std::setw(14) << "-";
+		os << std::endl;
+	}
+	os.flags(flags);
+	os.precision(precision);
+}
+
+void profiler::print_json(std::ostream & os)
+{
+	os << '{';
+	for (unsigned op = 0; op < profiled_ops::num_ops; ++op) {
+		if (op)
+			os << ',';
+		os << "\n  \"" << op_names[op] << "\": {\"calls\": " << data[op].calls;
+		if (is_timed(op))
+			os << ", \"seconds\": " << seconds(op) << ", \"objects\": " << data[op].objects;
+		os << '}';
+	}
+	os << "\n}" << std::endl;
+}
+
+void profile_scope::start()
+{
+	profiler::counters & c = profiler::data[op];
+	++c.calls;
+	outermost = (c.depth++ == 0);
+	if (outermost) {
+		start_objects = profiler::objects_created;
+		start_ticks = std::clock();
+	}
+}
+
+void profile_scope::stop()
+{
+	profiler::counters & c = profiler::data[op];
+	--c.depth;
+	if (outermost) {
+		c.ticks += std::clock() - start_ticks;
+		c.objects += profiler::objects_created - start_objects;
+	}
+}
+
+} // namespace GiNaC
@@ -0,0 +1,136 @@
+/** @file profiler.h
+ *
+ *  Interface to the runtime profiling of expensive operations. */
+
+/*
+ *  GiNaC Copyright (C) 1999-2011 Johannes Gutenberg University Mainz, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef GINAC_PROFILER_H
+#define GINAC_PROFILER_H
+
+#include <ctime>
+#include <iosfwd>
+
+namespace GiNaC {
+
+/** Operations recorded by the profiler. */
+class profiled_ops {
+public:
+	enum {
+		expand,
+		add_eval,
+		mul_eval,
+		power_eval,
+		compare,
+		subs,
+		normal,
+		series,
+		gcd,
+		heur_gcd,
+		sr_gcd,
+		chinrem_gcd,
+		zippel_gcd,
+		factor,
+		factor_univariate,
+		factor_multivariate,
+		hensel_univar,
+		hensel_multivar,
+		num_ops
+	};
+};
+
+/** Runtime profiling of the expensive operations.  While the profiler is
+ *  enabled, it counts the calls of the operations in profiled_ops, and for
+ *  most of them also the processor time spent and the number of expression
+ *  objects created.  Time and objects are counted for the outermost call
+ *  only when an operation calls itself recursively, so they are inclusive
+ *  of the operations called from it, but never counted twice.  The cheap
+ *  and very frequent operations (eval() and compare()) are only counted.
+ *
+ *  The profiler is off by default; when it is off, each operation costs
+ *  one more test of a flag. */
+class profiler {
+	friend class profile_scope;
+public:
+	static void enable() { enabled = true; }
+	static void disable() { enabled = false; }
+	static bool is_enabled() { return enabled; }
+
+	/** Set all counters to zero. */
+	static void reset();
+
+	/** Print a table of all operations that were called. */
+	static void print(std::ostream & os);
+
+	/** Print all counters as a JSON object. */
+	static void print_json(std::ostream & os);
+
+	static const char * name(unsigned op);
+	static unsigned long calls(unsigned op) { return data[op].calls; }
+	static double seconds(unsigned op) { return double(data[op].ticks) / CLOCKS_PER_SEC; }
+	static unsigned long objects(unsigned op) { return data[op].objects; }
+
+	/** Count a call of an operation that is not timed. */
+	static void count(unsigned op)
+	{
+		if (enabled)
+			++data[op].calls;
+	}
+
+	/** Number of expression objects created so far, counted by the
+	 *  constructors of class basic. */
+	static unsigned long objects_created;
+
+private:
+	struct counters {
+		unsigned long calls;
+		unsigned long objects;
+		std::clock_t ticks;
+		unsigned depth;
+	};
+	static bool enabled;
+	static counters data[profiled_ops::num_ops];
+};
+
+/** Records one call of an operation, from construction to destruction. */
+class profile_scope {
+public:
+	explicit profile_scope(unsigned op_) : op(op_), active(profiler::enabled)
+	{
+		if (active)
+			start();
+	}
+	~profile_scope()
+	{
+		if (active)
+			stop();
+	}
+private:
+	void start();
+	void stop();
+
+	unsigned op;
+	bool active;
+	bool outermost;
+	std::clock_t start_ticks;
+	unsigned long start_objects;
+};
+
+} // namespace GiNaC
+
+#endif // ndef GINAC_PROFILER_H
@@ -23,6 +23,7 @@
 
 #include "pseries.h"
 #include "add.h"
+#include "cancellation.h"
 #include "inifcns.h" // for Order function
 #include "lst.h"
 #include "mul.h"
@@ -654,6 +655,7 @@ ex basic::series(const relational & r, int order, unsigned options) const
 
 	int n;
 	for (n=1; n<order; ++n) {
+		cancellation::poll("series");
 		fac = fac.mul(n);
 		// We need to test for zero in order to see if the series terminates.
 		// The problem is that there is no such thing as a perfect test for
@@ -784,6 +786,7 @@ ex add::series(const relational & r, int order, unsigned options) const
 	epvector::const_iterator it = seq.begin();
 	epvector::const_iterator itend = seq.end();
 	for (; it!=itend; ++it) {
+		cancellation::poll("series");
 		ex op;
 		if (is_exactly_a<pseries>(it->rest))
 			op = it->rest;
@@ -827,6 +830,19 @@ ex pseries::mul_const(const numeric &other) const
  *  @param other  pseries object to multiply with
  *  @return the product as a pseries */
 ex pseries::mul_series(const pseries &other) const
+{
+	return mul_series(other, std::numeric_limits<int>::max());
+}
+
+
+/** Multiply one pseries object to another, producing a pseries object that
+ *  represents the product truncated at a given order.  Coefficients of powers
+ *  at or beyond the truncation order are not computed at all.
+ *
+ *  @param other  pseries object to multiply with
+ *  @param deg  truncation order of the product
+ *  @return the product as a pseries */
+ex pseries::mul_series(const pseries &other, int deg) const
 {
 	// Multiplying two series with different variables or expansion points
 	// results in an empty (constant) series 
@@ -843,30 +859,49 @@ ex pseries::mul_series(const pseries &other) const
 	
 	// Series multiplication
 	epvector new_seq;
-	int a_max = degree(var);
-	int b_max = other.degree(var);
-	int a_min = ldegree(var);
-	int b_min = other.ldegree(var);
-	int cdeg_min = a_min + b_min;
+	const int a_max = degree(var);
+	const int b_max = other.degree(var);
+	const int a_min = ldegree(var);
+	const int b_min = other.ldegree(var);
+	const int cdeg_min = a_min + b_min;
 	int cdeg_max = a_max + b_max;
 	
 	int higher_order_a = std::numeric_limits<int>::max();
 	int higher_order_b = std::numeric_limits<int>::max();
-	if (is_order_function(coeff(var, a_max)))
+	if (is_order_function((seq.end()-1)->rest))
 		higher_order_a = a_max + b_min;
-	if (is_order_function(other.coeff(var, b_max)))
+	if (is_order_function((other.seq.end()-1)->rest))
 		higher_order_b = b_max + a_min;
 	int higher_order_c = std::min(higher_order_a, higher_order_b);
+	if (deg <= cdeg_max && deg < higher_order_c)
+		higher_order_c = deg;
 	if (cdeg_max >= higher_order_c)
 		cdeg_max = higher_order_c - 1;
+
+	// Unpack the coefficients into dense arrays so that the convolution
+	// below doesn't have to search the sequences.  Order terms never
+	// contribute to the computed coefficients and are left out.
+	exvector a_coeffs(a_max - a_min + 1);
+	exvector b_coeffs(b_max - b_min + 1);
+	for (epvector::const_iterator it = seq.begin(); it != seq.end(); ++it) {
+		if (!is_order_function(it->rest))
+			a_coeffs[ex_to<numeric>(it->coeff).to_int() - a_min] = it->rest;
+	}
+	for (epvector::const_iterator it = other.seq.begin(); it != other.seq.end(); ++it) {
+		if (!is_order_function(it->rest))
+			b_coeffs[ex_to<numeric>(it->coeff).to_int() - b_min] = it->rest;
+	}
 	
 	for (int cdeg=cdeg_min; cdeg<=cdeg_max; ++cdeg) {
+		cancellation::poll("series");
 		ex co = _ex0;
 		// c(i)=a(0)b(i)+...+a(i)b(0)
-		for (int i=a_min; cdeg-i>=b_min; ++i) {
-			ex a_coeff = coeff(var, i);
-			ex b_coeff = other.coeff(var, cdeg-i);
-			if (!is_order_function(a_coeff) && !is_order_function(b_coeff))
+		const int i_min = std::max(a_min, cdeg - b_max);
+		const int i_max = std::min(a_max, cdeg - b_min);
+		for (int i=i_min; i<=i_max; ++i) {
+			const ex & a_coeff = a_coeffs[i - a_min];
+			const ex & b_coeff = b_coeffs[cdeg - i - b_min];
+			if (!a_coeff.is_zero() && !b_coeff.is_zero())
 				co += a_coeff * b_coeff;
 		}
 		if (!co.is_zero())
@@ -975,18 +1010,33 @@ ex mul::series(const relational & r, int order, unsigned options) const
 		return (new pseries(r, epv))->setflag(status_flags::dynallocated);
 	}
 
-	// Multiply with remaining terms
+	// Expand the factors with adjusted orders
+	exvector factors;
+	factors.reserve(seq.size());
+	bool terminating = true;
 	std::vector<int>::const_iterator itd = ldegrees.begin();
 	for (epvector::const_iterator it=itbeg; it!=itend; ++it, ++itd) {
-
-		// do series expansion with adjusted order
 		ex op = recombine_pair_to_ex(*it).series(r, order-degsum+(*itd), options);
+		if (!ex_to<pseries>(op).is_terminating())
+			terminating = false;
+		factors.push_back(op);
+	}
+
+	// Multiply them.  If the product is truncated anyway, the partial product
+	// of the first k factors is only needed up to the requested order minus
+	// the low degrees of the remaining factors.  Higher coefficients would be
+	// swallowed by the final order term and need not be computed.
+	int partial_order = order - degsum;
+	itd = ldegrees.begin();
+	for (exvector::const_iterator it=factors.begin(); it!=factors.end(); ++it, ++itd) {
+		partial_order += *itd;
+		const int trunc = terminating ? std::numeric_limits<int>::max() : partial_order;
 
 		// Series multiplication
-		if (it == itbeg)
-			acc = ex_to<pseries>(op);
+		if (it == factors.begin())
+			acc = ex_to<pseries>(*it);
 		else
-			acc = ex_to<pseries>(acc.mul_series(ex_to<pseries>(op)));
+			acc = ex_to<pseries>(acc.mul_series(ex_to<pseries>(*it), trunc));
 	}
 
 	return acc.mul_const(ex_to<numeric>(overall_coeff));
@@ -1049,27 +1099,50 @@ ex pseries::power_const(const numeric &p, int deg) const
 	if (seq.size() == 1 && is_order_function(seq[0].rest) && p.real().is_negative())
 		throw pole_error("pseries::power_const(): division by zero",1);
 	
+	// Unpack the coefficients of the series into a dense array, indexed by
+	// the offset from the leading power.  Only the coefficients below the
+	// order term (if any) can be determined for the powered series.
+	exvector a(numcoeff);
+	int numvalid = numcoeff;
+	for (epvector::const_iterator it = seq.begin(); it != seq.end(); ++it) {
+		const int offset = ex_to<numeric>(it->coeff).to_int() - ldeg;
+		if (offset >= numcoeff)
+			break;
+		if (is_order_function(it->rest)) {
+			numvalid = offset;
+			break;
+		}
+		a[offset] = it->rest;
+	}
+
+	// A pure order term O(x^n)^p is just O(x^(p*n))
+	if (numvalid == 0) {
+		epvector epv;
+		epv.push_back(expair(Order(_ex1), p * ldeg));
+		return (new pseries(relational(var,point), epv))
+		       ->setflag(status_flags::dynallocated);
+	}
+
 	// Compute coefficients of the powered series
 	exvector co;
-	co.reserve(numcoeff);
-	co.push_back(power(coeff(var, ldeg), p));
-	for (int i=1; i<numcoeff; ++i) {
+	co.reserve(numvalid + 1);
+	co.push_back(power(a[0], p));
+	for (int i=1; i<numvalid; ++i) {
+		cancellation::poll("series");
 		ex sum = _ex0;
 		for (int j=1; j<=i; ++j) {
-			ex c = coeff(var, j + ldeg);
-			if (is_order_function(c)) {
-				co.push_back(Order(_ex1));
-				break;
-			} else
-				sum += (p * j - (i - j)) * co[i - j] * c;
+			if (!a[j].is_zero())
+				sum += (p * j - (i - j)) * co[i - j] * a[j];
 		}
-		co.push_back(sum / coeff(var, ldeg) / i);
+		co.push_back(sum / a[0] / i);
 	}
+	if (numvalid < numcoeff)
+		co.push_back(Order(_ex1));
 	
 	// Construct new series (of non-zero coefficients)
 	epvector new_seq;
 	bool higher_order = false;
-	for (int i=0; i<numcoeff; ++i) {
+	for (int i=0; i<(int)co.size(); ++i) {
 		if (!co[i].is_zero())
 			new_seq.push_back(expair(co[i], p * ldeg + i));
 		if (is_order_function(co[i])) {
@@ -1280,17 +1353,23 @@ ex integral::series(const relational & r, int order, unsigned options) const
 }
 
 
+/** Number of times the truncation order is raised in vain with
+ *  series_options::relative_order before the order term is returned. */
+static const int max_relative_order_retries = 10;
+
 /** Compute the truncated series expansion of an expression.
  *  This function returns an expression containing an object of class pseries 
  *  to represent the series. If the series does not terminate within the given
  *  truncation order, the last term of the series will be an order term.
  *
  *  @param r  expansion relation, lhs holds variable and rhs holds point
- *  @param order  truncation order of series calculations
+ *  @param order  truncation order of series calculations (relative to the
+ *                leading power if series_options::relative_order is given)
  *  @param options  of class series_options
  *  @return an expression holding a pseries object */
 ex ex::series(const ex & r, int order, unsigned options) const
 {
+	profile_scope prof(profiled_ops::series);
 	ex e;
 	relational rel_;
 	
@@ -1301,8 +1380,48 @@ ex ex::series(const ex & r, int order, unsigned options) const
 	else
 		throw (std::logic_error("ex::series(): expansion point has unknown type"));
 	
-	e = bp->series(rel_, order, options);
-	return e;
+	if (!(options & series_options::relative_order)) {
+		e = bp->series(rel_, order, options);
+		return e;
+	}
+
+	// Relative truncation: the option is only meaningful at the top level,
+	// all sub-expansions are done with absolute orders.
+	options &= ~series_options::relative_order;
+	int abs_order = order;
+	e = bp->series(rel_, abs_order, options);
+	if (!is_a<pseries>(e))
+		return e;
+
+	// Raise the order until the leading term is not swallowed by the order
+	// term any more.  An expression that is zero without being recognized
+	// as such (like sin(x)^2+cos(x)^2-1) never gets a leading term, so give
+	// up after a while and return the order term.
+	for (int retries = 0; ex_to<pseries>(e).nops() == 1 && is_order_function(ex_to<pseries>(e).coeffop(0)); ++retries) {
+		if (retries == max_relative_order_retries)
+			return e;
+		abs_order += std::max(order, 1);
+		e = bp->series(rel_, abs_order, options);
+	}
+	if (ex_to<pseries>(e).is_zero())
+		return e;
+
+	const pseries & s = ex_to<pseries>(e);
+	const int target = s.ldegree(rel_.lhs()) + order;
+	if (target > abs_order)
+		return bp->series(rel_, target, options);
+	if (s.is_terminating() && s.degree(rel_.lhs()) < target)
+		return e;
+
+	// Cut off the terms that were computed in excess
+	epvector new_seq;
+	for (size_t i=0; i<s.nops(); ++i) {
+		if (ex_to<numeric>(s.exponop(i)).to_int() >= target)
+			break;
+		new_seq.push_back(expair(s.coeffop(i), s.exponop(i)));
+	}
+	new_seq.push_back(expair(Order(_ex1), target));
+	return (new pseries(rel_, new_seq))->setflag(status_flags::dynallocated);
 }
 
 GINAC_BIND_UNARCHIVER(pseries);
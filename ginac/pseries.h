@@ -53,7 +53,7 @@ public:
 	ex evalf(int level=0) const;
 	ex series(const relational & r, int order, unsigned options = 0) const;
 	ex subs(const exmap & m, unsigned options = 0) const;
-	ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const;
+	ex normal(exmap & repl, exmap & rev_lookup, int level = 0, unsigned options = 0) const;
 	ex expand(unsigned options = 0) const;
 	ex conjugate() const;
 	ex real_part() const;
@@ -98,6 +98,7 @@ public:
 	ex add_series(const pseries &other) const;
 	ex mul_const(const numeric &other) const;
 	ex mul_series(const pseries &other) const;
+	ex mul_series(const pseries &other, int deg) const;
 	ex power_const(const numeric &p, int deg) const;
 	pseries shift_exponents(int deg) const;
 
@@ -25,6 +25,9 @@
 #include "utils.h"
 #include "remember.h"
 
+#include <algorithm>
+#include <iostream>
+#include <map>
 #include <stdexcept>
 
 namespace GiNaC {
@@ -33,11 +36,37 @@ namespace GiNaC {
 // class remember_table_entry
 //////////
 
+namespace {
+
+/** Add a rough estimate of the memory used by the objects of an expression
+ *  that are not in "seen" yet: the size of a basic object plus one ex per
+ *  operand for every object.  The objects are held in "seen", so the
+ *  addresses of temporary operands are not reused while counting. */
+void add_object_sizes(const ex & e, std::map<const basic *, ex> & seen, size_t & bytes)
+{
+	if (!seen.insert(std::make_pair(&ex_to<basic>(e), e)).second)
+		return;
+	const size_t num = e.nops();
+	bytes += sizeof(basic) + num * sizeof(ex);
+	for (size_t i=0; i<num; ++i)
+		add_object_sizes(e.op(i), seen, bytes);
+}
+
+} // anonymous namespace
+
 remember_table_entry::remember_table_entry(function const & f, ex const & r)
   : hashvalue(f.gethash()), seq(f.seq), result(r)
 {
-	++last_access = access_counter;
+	creation = last_access = ++access_counter;
 	successful_hits = 0;
+
+	// The table often holds the only reference to the result, so the
+	// argument and result objects are counted, each of them once
+	bytes = sizeof(remember_table_entry) + seq.capacity() * sizeof(ex);
+	std::map<const basic *, ex> seen;
+	for (exvector::const_iterator it = seq.begin(); it != seq.end(); ++it)
+		add_object_sizes(*it, seen, bytes);
+	add_object_sizes(result, seen, bytes);
 }
 
 bool remember_table_entry::is_equal(function const & f) const
@@ -47,138 +76,221 @@ bool remember_table_entry::is_equal(function const & f) const
 	size_t num = seq.size();
 	for (size_t i=0; i<num; ++i)
 		if (!seq[i].is_equal(f.seq[i])) return false;
-	++last_access = access_counter;
+	last_access = ++access_counter;
 	++successful_hits;
 	return true;
 }
 
-unsigned long remember_table_entry::access_counter = 0;
-
-//////////
-// class remember_table_list
-//////////
-
-remember_table_list::remember_table_list(unsigned as, unsigned strat)
-{
-	max_assoc_size = as;
-	remember_strategy = strat;
-}
-
-
-void remember_table_list::add_entry(function const & f, ex const & result)
+/** Approximate memory used by the entry, including the objects of the
+ *  arguments and of the result (even if they are shared with other
+ *  expressions). */
+size_t remember_table_entry::memory_size() const
 {
-	if ((max_assoc_size!=0) &&
-		(remember_strategy!=remember_strategies::delete_never) &&
-		(size()>=max_assoc_size)) {
-		// table is full, we must delete an older entry
-		GINAC_ASSERT(size()>0); // there must be at least one entry
-		
-		switch (remember_strategy) {
-		case remember_strategies::delete_cyclic: {
-			// delete oldest entry (first in list)
-			erase(begin());
-			break;
-		}
-		case remember_strategies::delete_lru: {
-			// delete least recently used entry
-			iterator it = begin();
-			iterator lowest_access_it = it;
-			unsigned long lowest_access = (*it).get_last_access();
-			++it;
-			while (it!=end()) {
-				if ((*it).get_last_access()<lowest_access) {
-					lowest_access = (*it).get_last_access();
-					lowest_access_it = it;
-				}
-				++it;
-			}
-			erase(lowest_access_it);
-			break;
-		}
-		case remember_strategies::delete_lfu: {
-			// delete least frequently used entry
-			iterator it = begin();
-			iterator lowest_hits_it = it;
-			unsigned lowest_hits = (*it).get_successful_hits();
-			++it;
-			while (it!=end()) {
-				if ((*it).get_successful_hits()<lowest_hits) {
-					lowest_hits = (*it).get_successful_hits();
-					lowest_hits_it = it;
-				}
-				++it;
-			}
-			erase(lowest_hits_it);
-			break;
-		}
-		default:
-			throw(std::logic_error("remember_table_list::add_entry(): invalid remember_strategy"));
-        }
-		GINAC_ASSERT(size()==max_assoc_size-1);
-	}
-	push_back(remember_table_entry(f,result));
+	return bytes;
 }
 
-bool remember_table_list::lookup_entry(function const & f, ex & result) const
-{
-	const_iterator i = begin(), iend = end();
-	while (i != iend) {
-		if (i->is_equal(f)) {
-			result = i->get_result();
-			return true;
-		}
-		++i;
-	}
-	return false;
-}
+unsigned long remember_table_entry::access_counter = 0;
 
 //////////
 // class remember_table
 //////////
 
+size_t remember_table::memory_limit = 0;
+size_t remember_table::total_bytes = 0;
+
 remember_table::remember_table()
 {
 	table_size=0;
 	max_assoc_size=0;
 	remember_strategy=remember_strategies::delete_never;
+	num_entries = bytes = 0;
+	lookups = hits = discarded = 0;
 }
 
-remember_table::remember_table(unsigned s, unsigned as, unsigned strat)
-  : max_assoc_size(as), remember_strategy(strat)
+remember_table::remember_table(const std::string & n, unsigned s, unsigned as, unsigned strat)
+  : name(n), max_assoc_size(as), remember_strategy(strat)
 {
 	// we keep max_assoc_size and remember_strategy if we need to clear
 	// all entries
 	
 	// use some power of 2 next to s
 	table_size = 1 << log2(s);
+	num_entries = bytes = 0;
+	lookups = hits = discarded = 0;
 	init_table();
 }
 
 bool remember_table::lookup_entry(function const & f, ex & result) const
 {
-	unsigned entry = f.gethash() & (table_size-1);
-	GINAC_ASSERT(entry<size());
-	return operator[](entry).lookup_entry(f,result);
+	++lookups;
+	if (num_entries == 0)
+		return false;
+
+	const remember_table_list & slot = slots[f.gethash() & (table_size-1)];
+	for (remember_table_list::const_iterator it = slot.begin(); it != slot.end(); ++it) {
+		if (it->is_equal(f)) {
+			result = it->get_result();
+			++hits;
+			return true;
+		}
+	}
+	return false;
 }
 
 void remember_table::add_entry(function const & f, ex const & result)
 {
-	unsigned entry = f.gethash() & (table_size-1);
-	GINAC_ASSERT(entry<size());
-	operator[](entry).add_entry(f,result);
-}        
+	remember_table_list & slot = slots[f.gethash() & (table_size-1)];
+	remember_table_entry e(f, result);
+
+	if ((max_assoc_size!=0) &&
+		(remember_strategy!=remember_strategies::delete_never) &&
+		(slot.size()>=max_assoc_size)) {
+		// slot is full, we must replace an older entry
+		GINAC_ASSERT(slot.size()>0); // there must be at least one entry
+
+		remember_table_list::iterator victim = slot.begin();
+		switch (remember_strategy) {
+		case remember_strategies::delete_cyclic:
+			// replace oldest entry
+			for (remember_table_list::iterator it = slot.begin(); it != slot.end(); ++it)
+				if (it->get_creation() < victim->get_creation())
+					victim = it;
+			break;
+		case remember_strategies::delete_lru:
+			// replace least recently used entry
+			for (remember_table_list::iterator it = slot.begin(); it != slot.end(); ++it)
+				if (it->get_last_access() < victim->get_last_access())
+					victim = it;
+			break;
+		case remember_strategies::delete_lfu:
+			// replace least frequently used entry
+			for (remember_table_list::iterator it = slot.begin(); it != slot.end(); ++it)
+				if (it->get_successful_hits() < victim->get_successful_hits())
+					victim = it;
+			break;
+		default:
+			throw(std::logic_error("remember_table::add_entry(): invalid remember_strategy"));
+		}
+
+		const size_t old_bytes = victim->memory_size();
+		bytes -= old_bytes;
+		total_bytes -= old_bytes;
+		++discarded;
+		*victim = e;
+	} else {
+		if (slot.capacity() == 0 && max_assoc_size != 0)
+			slot.reserve(max_assoc_size);
+		slot.push_back(e);
+		++num_entries;
+	}
+
+	const size_t new_bytes = e.memory_size();
+	bytes += new_bytes;
+	total_bytes += new_bytes;
+
+	// Tables without a bound on the slot size grow with the number of
+	// entries
+	if ((max_assoc_size==0 || remember_strategy==remember_strategies::delete_never)
+	 && num_entries > 2 * size_t(table_size))
+		grow();
+
+	if (memory_limit != 0 && total_bytes > memory_limit)
+		enforce_memory_limit();
+}
 
 void remember_table::clear_all_entries()
 {
-	clear();
+	total_bytes -= bytes;
+	bytes = 0;
+	num_entries = 0;
+	slots.clear();
 	init_table();
 }
 
+/** Print the size and the hit rate of the table. */
+void remember_table::show_statistics(std::ostream & os, unsigned level) const
+{
+	os << std::string(level, ' ') << name << ": "
+	   << num_entries << " entries in " << table_size << " slots, "
+	   << bytes << " bytes, "
+	   << lookups << " lookups, " << hits << " hits";
+	if (lookups)
+		os << " (" << (100.0 * hits / lookups) << "%)";
+	os << ", " << discarded << " entries discarded" << std::endl;
+}
+
 void remember_table::init_table()
 {
-	reserve(table_size);
-	for (unsigned i=0; i<table_size; ++i)
-		push_back(remember_table_list(max_assoc_size,remember_strategy));
+	slots.resize(table_size);
+}
+
+/** Double the number of slots and redistribute the entries. */
+void remember_table::grow()
+{
+	std::vector<remember_table_list> old_slots;
+	old_slots.swap(slots);
+	table_size *= 2;
+	slots.resize(table_size);
+	for (std::vector<remember_table_list>::const_iterator s = old_slots.begin(); s != old_slots.end(); ++s)
+		for (remember_table_list::const_iterator it = s->begin(); it != s->end(); ++it)
+			slots[it->get_hashvalue() & (table_size-1)].push_back(*it);
+}
+
+/** Remove all entries which were last used at or before the given time. */
+void remember_table::discard_entries(unsigned long threshold)
+{
+	for (std::vector<remember_table_list>::iterator s = slots.begin(); s != slots.end(); ++s) {
+		remember_table_list::iterator keep = s->begin();
+		for (remember_table_list::iterator it = s->begin(); it != s->end(); ++it) {
+			if (it->get_last_access() <= threshold) {
+				const size_t old_bytes = it->memory_size();
+				bytes -= old_bytes;
+				total_bytes -= old_bytes;
+				--num_entries;
+				++discarded;
+			} else {
+				if (keep != it)
+					*keep = *it;
+				++keep;
+			}
+		}
+		s->erase(keep, s->end());
+	}
+}
+
+/** Discard the least recently used entries of all tables, so that the
+ *  memory used is at most three quarters of the limit afterwards (assuming
+ *  entries of similar size). */
+void remember_table::enforce_memory_limit()
+{
+	std::vector<remember_table> & tables = remember_tables();
+
+	std::vector<unsigned long> accesses;
+	for (std::vector<remember_table>::const_iterator t = tables.begin(); t != tables.end(); ++t)
+		for (std::vector<remember_table_list>::const_iterator s = t->slots.begin(); s != t->slots.end(); ++s)
+			for (remember_table_list::const_iterator it = s->begin(); it != s->end(); ++it)
+				accesses.push_back(it->get_last_access());
+	if (accesses.empty())
+		return;
+
+	const double keep_fraction = 0.75 * memory_limit / total_bytes;
+	size_t n = size_t(accesses.size() * (1.0 - keep_fraction));
+	if (n >= accesses.size())
+		n = accesses.size() - 1;
+	std::nth_element(accesses.begin(), accesses.begin() + n, accesses.end());
+	const unsigned long threshold = accesses[n];
+
+	for (std::vector<remember_table>::iterator t = tables.begin(); t != tables.end(); ++t)
+		t->discard_entries(threshold);
+}
+
+/** Limit the memory used by the remember tables of all functions together
+ *  (0 means no limit). */
+void remember_table::set_memory_limit(size_t limit)
+{
+	memory_limit = limit;
+	if (memory_limit != 0 && total_bytes > memory_limit)
+		enforce_memory_limit();
 }
 
 std::vector<remember_table> & remember_table::remember_tables()
@@ -24,8 +24,9 @@
 #ifndef GINAC_REMEMBER_H
 #define GINAC_REMEMBER_H
 
+#include <cstddef>
 #include <iosfwd>
-#include <list>
+#include <string>
 #include <vector>
 
 namespace GiNaC {
@@ -44,27 +45,24 @@ public:
 	ex get_result() const { return result; }
 	unsigned long get_last_access() const { return last_access; }
 	unsigned long get_successful_hits() const { return successful_hits; };
+	unsigned long get_creation() const { return creation; }
+	unsigned get_hashvalue() const { return hashvalue; }
+	std::size_t memory_size() const;
 
 protected:
 	unsigned hashvalue;
 	exvector seq;
 	ex result;
+	unsigned long creation;
 	mutable unsigned long last_access;
-	mutable unsigned successful_hits;
+	mutable unsigned long successful_hits;
+	std::size_t bytes;  ///< estimated memory used, see memory_size()
 	static unsigned long access_counter;
 };    
 
-/** A list of entries in the remember table having some least
- *  significant bits of the hashvalue in common. */
-class remember_table_list : public std::list<remember_table_entry> {
-public:
-	remember_table_list(unsigned as, unsigned strat);
-	void add_entry(function const & f, ex const & result);
-	bool lookup_entry(function const & f, ex & result) const;
-protected:
-	unsigned max_assoc_size;
-	unsigned remember_strategy;
-};
+/** The entries in the remember table having some least significant bits of
+ *  the hashvalue in common, stored contiguously. */
+typedef std::vector<remember_table_entry> remember_table_list;
 
 /** The remember table is organized like an n-fold associative cache
  *  in a microprocessor.  The table has a width of 's' (which is rounded
@@ -75,25 +73,50 @@ protected:
  *  The 'log_2(table_size)' least significant bits of this hashvalue
  *  give the slot in which the entry will be stored or looked up.
  *  Each slot can take up to 'as' entries. If a slot is full, an older
- *  entry is removed by one of the following strategies:
- *   - oldest entry (the first one in the list)
+ *  entry is replaced by one of the following strategies:
+ *   - oldest entry (the one with the lowest 'creation')
  *   - least recently used (the one with the lowest 'last_access')
  *   - least frequently used (the one with the lowest 'successful_hits')
- *  or all entries are kept which means that the table grows indefinitely. */
-class remember_table : public std::vector<remember_table_list> {
+ *  or all entries are kept which means that the table grows indefinitely.
+ *  Growing tables double their width whenever they hold more than two
+ *  entries per slot on average, so lookups stay fast.
+ *
+ *  Independently of the strategy, the memory used by all remember tables
+ *  together can be limited.  When the limit is exceeded, the least recently
+ *  used entries of all tables are discarded until a quarter of the limit is
+ *  available again, so the cost of that is spread over many insertions. */
+class remember_table {
 public:
 	remember_table();
-	remember_table(unsigned s, unsigned as, unsigned strat);
+	remember_table(const std::string & n, unsigned s, unsigned as, unsigned strat);
 	bool lookup_entry(function const & f, ex & result) const;
 	void add_entry(function const & f, ex const & result);
 	void clear_all_entries();
 	void show_statistics(std::ostream & os, unsigned level) const;
+	std::size_t size() const { return num_entries; }
+	std::size_t memory_size() const { return bytes; }
 	static std::vector<remember_table> & remember_tables();
+	static void set_memory_limit(std::size_t limit);
+	static std::size_t get_memory_limit() { return memory_limit; }
+	static std::size_t total_memory_size() { return total_bytes; }
 protected:
 	void init_table();
+	void grow();
+	void discard_entries(unsigned long threshold);
+	static void enforce_memory_limit();
+
+	std::string name;
+	std::vector<remember_table_list> slots;
 	unsigned table_size;
 	unsigned max_assoc_size;
 	unsigned remember_strategy;
+	std::size_t num_entries;
+	std::size_t bytes;
+	mutable unsigned long lookups;
+	mutable unsigned long hits;
+	unsigned long discarded;
+	static std::size_t memory_limit;
+	static std::size_t total_bytes;
 };      
 
 } // namespace GiNaC
@@ -179,7 +179,7 @@ public:
 	ex series(const relational & r, int order, unsigned options = 0) const { return inherited::series(r, order, options); }
 
 	// rational functions
-	ex normal(exmap & repl, exmap & rev_lookup, int level = 0) const { return inherited::normal(repl, rev_lookup, level); }
+	ex normal(exmap & repl, exmap & rev_lookup, int level = 0, unsigned options = 0) const { return inherited::normal(repl, rev_lookup, level, options); }
 	ex to_rational(exmap & repl) const { return inherited::to_rational(repl); }
 	ex to_polynomial(exmap & repl) const { return inherited::to_polynomial(repl); }
 
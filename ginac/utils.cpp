@@ -259,6 +259,10 @@ const ex _ex60 = _ex60;
 const numeric *_num120_p;
 const ex _ex120 = _ex120;
 
+// shared numerics for the small integers, and the expressions holding them
+const numeric *_num_small_p[2*small_integer_max + 1];
+static ex *_ex_small = 0;
+
 /** Ctor of static initialization helpers.  The fist call to this is going
  *  to initialize the library, the others do nothing. */
 library_init::library_init()
@@ -365,6 +369,29 @@ library_init::library_init()
 		new((void*)&_ex60) ex(*_num60_p);
 		new((void*)&_ex120) ex(*_num120_p);
 
+		// Shared numerics for the small integers, using the ones above
+		const numeric *flyweights[] = {
+			_num_120_p, _num_60_p, _num_48_p, _num_30_p, _num_25_p,
+			_num_24_p, _num_20_p, _num_18_p, _num_15_p, _num_12_p,
+			_num_11_p, _num_10_p, _num_9_p, _num_8_p, _num_7_p, _num_6_p,
+			_num_5_p, _num_4_p, _num_3_p, _num_2_p, _num_1_p, _num0_p,
+			_num1_p, _num2_p, _num3_p, _num4_p, _num5_p, _num6_p, _num7_p,
+			_num8_p, _num9_p, _num10_p, _num11_p, _num12_p, _num15_p,
+			_num18_p, _num20_p, _num24_p, _num25_p, _num30_p, _num48_p,
+			_num60_p, _num120_p
+		};
+		for (long i = -small_integer_max; i <= small_integer_max; ++i)
+			_num_small_p[i + small_integer_max] = 0;
+		for (size_t i = 0; i < sizeof(flyweights) / sizeof(flyweights[0]); ++i)
+			_num_small_p[flyweights[i]->to_long() + small_integer_max] = flyweights[i];
+		_ex_small = new ex[2*small_integer_max + 1];
+		for (long i = -small_integer_max; i <= small_integer_max; ++i) {
+			const numeric *&p = _num_small_p[i + small_integer_max];
+			if (!p)
+				(p = new numeric(i))->setflag(status_flags::dynallocated);
+			_ex_small[i + small_integer_max] = *p;
+		}
+
 		// Initialize print context class info (this is not strictly necessary
 		// but we do it anyway to make print_context_class_info::dump_hierarchy()
 		// output the whole hierarchy whether or not the classes are actually
@@ -392,6 +419,7 @@ library_init::~library_init()
 		// lifetime might not be the same as libginac.{so,dll} one
 		// (e.g. consider // dlopen/dlsym/dlclose sequence).
 		// Let the ex dtors care for deleting the numerics!
+		delete[] _ex_small;
 		_ex120.~ex();
 		_ex_120.~ex();
 		_ex60.~ex();
@@ -30,6 +30,7 @@
 #endif
 
 #include <functional>
+#include <map>
 #ifdef HAVE_STDINT_H
 #include <stdint.h> // for uintptr_t
 #endif
@@ -412,6 +413,27 @@ extern const ex _ex60;
 extern const numeric *_num120_p;
 extern const ex _ex120;
 
+/** Range of the integers that have shared numeric objects (including the
+ *  ones above), so that arithmetic with small coefficients does not have to
+ *  allocate a new object for every result. */
+const long small_integer_max = 1024;
+extern const numeric *_num_small_p[2*small_integer_max + 1];
+
+/** Shared numeric object for the integer i, which must lie in the range
+ *  -small_integer_max..small_integer_max. */
+inline const numeric *small_integer_numeric(long i)
+{
+	return _num_small_p[i + small_integer_max];
+}
+
+class ex_is_less;
+
+/** Substitute in an expression within the current substitution run, as
+ *  ex::subs() does (implemented in basic.cpp).  The map is an exmap, and
+ *  temporary_refs is the number of references to the object of e held by
+ *  temporary copies of the caller. */
+extern ex subs_with_memo(const ex & e, const std::map<ex, ex, ex_is_less> & m, unsigned options, unsigned temporary_refs = 0);
+
 
 // Helper macros for class implementations (mostly useful for trivial classes)
 